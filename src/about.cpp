@@ -321,7 +321,7 @@ void AboutIndexDelegate::initInstalledFiles()
   std::set<Registry::File> allFiles;
 
   try {
-    Registry reg(Path::REGISTRY.prependRoot());
+    const Registry reg(Path::REGISTRY.prependRoot(), Registry::ReadOnly);
     for(const Registry::Entry &entry : reg.getEntries(m_index->name())) {
       const std::vector<Registry::File> &files = reg.getFiles(entry);
       allFiles.insert(files.begin(), files.end());
@@ -438,7 +438,7 @@ void AboutIndexDelegate::aboutPackage()
   VersionName current;
 
   try {
-    Registry reg(Path::REGISTRY.prependRoot());
+    const Registry reg(Path::REGISTRY.prependRoot(), Registry::ReadOnly);
     current = reg.getEntry(pkg).version;
   }
   catch(const reapack_error &) {}
@@ -50,10 +50,15 @@ namespace API {
 
   // api_package.cpp
   extern APIFunc AboutInstalledPackage;
+  extern APIFunc CountListEntries;
   extern APIFunc EnumOwnedFiles;
   extern APIFunc FreeEntry;
+  extern APIFunc FreeEntryList;
   extern APIFunc GetEntryInfo;
+  extern APIFunc GetInstalledEntries;
+  extern APIFunc GetListEntry;
   extern APIFunc GetOwner;
+  extern APIFunc GetOwners;
 
   // api_repo.cpp
   extern APIFunc AboutRepository;
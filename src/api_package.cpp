@@ -23,21 +23,48 @@
 #include "index.hpp"
 #include "reapack.hpp"
 #include "registry.hpp"
+#include "registry_cache.hpp"
 #include "remote.hpp"
 #include "transaction.hpp"
 
+#include <sstream>
+
 struct PackageEntry {
   Registry::Entry regEntry;
-  std::vector<Registry::File> files;
+  const std::vector<Registry::File> &files;
+  RegistryCachePtr cache; // owns the files
+};
+
+// entries returned by the batched functions are owned by their list
+struct PackageEntryList {
+  RegistryCachePtr cache;
+  std::vector<std::unique_ptr<PackageEntry>> entries;
+  std::vector<PackageEntry *> items;
+
+  PackageEntry *add(const Registry::Entry &);
 };
 
-static std::set<PackageEntry *> s_entries;
+static std::set<PackageEntry *> s_entries, s_listedEntries;
+static std::set<PackageEntryList *> s_lists;
+
+static bool isValid(PackageEntry *entry)
+{
+  return s_entries.count(entry) || s_listedEntries.count(entry);
+}
+
+PackageEntry *PackageEntryList::add(const Registry::Entry &regEntry)
+{
+  auto entry = new PackageEntry{regEntry, cache->getFiles(regEntry), cache};
+  entries.emplace_back(entry);
+  s_listedEntries.insert(entry);
+  return entry;
+}
 
 DEFINE_API(bool, AboutInstalledPackage, ((PackageEntry*, entry)),
 R"(Show the about dialog of the given package entry.
 The repository index is downloaded asynchronously if the cached copy doesn't exist or is older than one week.)",
 {
-  if(!s_entries.count(entry))
+  if(!isValid(entry))
     return false;
 
   // the one given by the user may be deleted while we download the idnex
@@ -78,7 +105,7 @@ type: see <a href="#ReaPack_GetEntryInfo">ReaPack_GetEntryInfo</a>.)",
 {
   const size_t i = index;
 
-  if(!s_entries.count(entry) || i >= entry->files.size())
+  if(!isValid(entry) || i >= entry->files.size())
     return false;
 
   const Registry::File &file = entry->files[i];
@@ -93,7 +120,8 @@ type: see <a href="#ReaPack_GetEntryInfo">ReaPack_GetEntryInfo</a>.)",
 });
 
 DEFINE_API(bool, FreeEntry, ((PackageEntry*, entry)),
-R"(Free resources allocated for the given package entry.)",
+R"(Free resources allocated for the given package entry.
+Entries obtained from a list are freed along with it by <a href="#ReaPack_FreeEntryList">ReaPack_FreeEntryList</a>.)",
 {
   if(!s_entries.count(entry))
     return false;
@@ -113,7 +141,7 @@ R"(Get the repository name, category, package name, package description, package
 
 type: 1=script, 2=extension, 3=effect, 4=data, 5=theme, 6=langpack, 7=webinterface)",
 {
-  if(!s_entries.count(entry))
+  if(!isValid(entry))
     return false;
 
   const Registry::Entry &regEntry = entry->regEntry;
@@ -145,11 +173,11 @@ R"(Returns the package entry owning the given file.
 Delete the returned object from memory after use with <a href="#ReaPack_FreeEntry">ReaPack_FreeEntry</a>.)",
 {
   try {
-    const Registry reg(Path::REGISTRY.prependRoot());
-    const auto &owner = reg.getOwner(Path(fn).removeRoot());
+    const RegistryCachePtr &reg = RegistryCache::get();
+    const auto &owner = reg->getOwner(Path(fn).removeRoot());
 
     if(owner) {
-      auto entry = new PackageEntry{owner, reg.getFiles(owner)};
+      auto entry = new PackageEntry{owner, reg->getFiles(owner), reg};
       s_entries.insert(entry);
       return entry;
     }
@@ -166,3 +194,105 @@ Delete the returned object from memory after use with <a href="#ReaPack_FreeEntr
     return nullptr;
   }
 });
+
+DEFINE_API(PackageEntryList*, GetInstalledEntries, ((const char*, remote))
+  ((char*, errorOut))((int, errorOut_sz)),
+R"(Returns a list of every installed package entry, or only those from the given repository when its name is not empty.
+Use <a href="#ReaPack_CountListEntries">ReaPack_CountListEntries</a> and <a href="#ReaPack_GetListEntry">ReaPack_GetListEntry</a> to iterate over it.
+Delete the returned object from memory after use with <a href="#ReaPack_FreeEntryList">ReaPack_FreeEntryList</a>.)",
+{
+  try {
+    auto list = new PackageEntryList{RegistryCache::get()};
+    const bool allRemotes = !remote || !*remote;
+
+    for(const Registry::Entry &regEntry : list->cache->entries()) {
+      if(allRemotes || regEntry.remote == remote)
+        list->items.push_back(list->add(regEntry));
+    }
+
+    s_lists.insert(list);
+    return list;
+  }
+  catch(const reapack_error &e)
+  {
+    if(errorOut)
+      snprintf(errorOut, errorOut_sz, "%s", e.what());
+
+    return nullptr;
+  }
+});
+
+DEFINE_API(PackageEntryList*, GetOwners, ((const char*, paths))
+  ((char*, errorOut))((int, errorOut_sz)),
+R"(Returns the package entries owning the given newline-separated list of files.
+The list has one item per file, in the same order. Items of files not owned by any package entry are nil.
+Delete the returned object from memory after use with <a href="#ReaPack_FreeEntryList">ReaPack_FreeEntryList</a>.)",
+{
+  try {
+    auto list = new PackageEntryList{RegistryCache::get()};
+    std::unordered_map<Registry::Entry::id_t, PackageEntry *> owners;
+
+    std::istringstream stream(paths ? paths : "");
+    std::string fn;
+    while(std::getline(stream, fn)) {
+      if(!fn.empty() && fn.back() == '\r')
+        fn.pop_back();
+
+      const auto &owner = list->cache->getOwner(Path(fn).removeRoot());
+      if(!owner) {
+        list->items.push_back(nullptr);
+        continue;
+      }
+
+      auto &entry = owners[owner.id];
+      if(!entry)
+        entry = list->add(owner);
+      list->items.push_back(entry);
+    }
+
+    s_lists.insert(list);
+    return list;
+  }
+  catch(const reapack_error &e)
+  {
+    if(errorOut)
+      snprintf(errorOut, errorOut_sz, "%s", e.what());
+
+    return nullptr;
+  }
+});
+
+DEFINE_API(int, CountListEntries, ((PackageEntryList*, list)),
+R"(Returns the number of items in the given package entry list.)",
+{
+  if(!s_lists.count(list))
+    return 0;
+
+  return static_cast<int>(list->items.size());
+});
+
+DEFINE_API(PackageEntry*, GetListEntry, ((PackageEntryList*, list))((int, index)),
+R"(Returns the package entry at the given index of the list.
+The entry remains valid until the list is freed. Do not free it using <a href="#ReaPack_FreeEntry">ReaPack_FreeEntry</a>.)",
+{
+  const size_t i = index;
+
+  if(!s_lists.count(list) || i >= list->items.size())
+    return nullptr;
+
+  return list->items[i];
+});
+
+DEFINE_API(bool, FreeEntryList, ((PackageEntryList*, list)),
+R"(Free resources allocated for the given package entry list and all of its entries.)",
+{
+  if(!s_lists.count(list))
+    return false;
+
+  for(const auto &entry : list->entries)
+    s_listedEntries.erase(entry.get());
+
+  s_lists.erase(list);
+  delete list;
+  return true;
+});
@@ -123,6 +123,11 @@ void ImportArchive::importRemote(const std::string &data)
       remote.name().c_str(), err));
   }
 
+  // the validators and snapshot of the previous download don't describe
+  // the extracted copy
+  FS::remove(Index::validatorsPathFor(remote.name()));
+  FS::remove(Index::snapshotPathFor(remote.name()));
+
   const Remote &original = m_remotes->get(remote.name());
   if(original.isProtected()) {
     remote.setUrl(original.url());
@@ -65,7 +65,7 @@ bool ExportTask::start()
       }
 
       toc << "PACK "
-        << quoted(entry.category) << '\x20'
+        << quoted(entry.category.str()) << '\x20'
         << quoted(entry.package) << '\x20'
         << quoted(entry.version.toString()) << '\x20'
         << entry.flags << '\n'
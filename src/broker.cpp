@@ -0,0 +1,179 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "broker.hpp"
+
+#include "config.hpp"
+#include "download.hpp"
+#include "filesystem.hpp"
+#include "reapack.hpp"
+#include "store.hpp"
+#include "transaction.hpp"
+
+#include <fstream>
+
+SharedFile::SharedFile(const Path &target)
+  : m_path(target), m_move(false), m_size(0)
+{
+  setSummary({ "Copying", target.join() });
+}
+
+bool SharedFile::run()
+{
+  if(m_move) {
+    // no other package needs the downloaded file anymore
+    if(!FS::mkdir(m_path.temp().dirname()) ||
+        !FS::rename(m_source, m_path.temp())) {
+      setError({FS::lastError(), m_path.temp().join()});
+      return false;
+    }
+
+    return true;
+  }
+
+  std::ifstream in;
+  if(!FS::open(in, m_source)) {
+    setError({FS::lastError(), m_source.join()});
+    return false;
+  }
+
+  std::ofstream out;
+  if(!FS::open(out, m_path.temp())) {
+    setError({FS::lastError(), m_path.temp().join()});
+    return false;
+  }
+
+  out << in.rdbuf();
+  out.close();
+
+  if(!out || in.bad()) {
+    setError({"Could not copy the file", m_path.target().join()});
+    return false;
+  }
+
+  return true;
+}
+
+DownloadBroker::DownloadBroker(Transaction *tx)
+  : m_tx(tx)
+{
+}
+
+SharedFile *DownloadBroker::fetch(const std::string &url,
+  const std::string &checksum, const Path &target, const int64_t sizeHint)
+{
+  SharedFile *file = new SharedFile(target);
+
+  // the checksum cannot contain spaces
+  const std::string &key = checksum + ' ' + url;
+
+  if(const auto &it = m_transfers.find(key); it != m_transfers.end()) {
+    it->second->files.push_back(file);
+    return file;
+  }
+
+  const TransferPtr transfer = std::make_shared<Transfer>(
+    Transfer{key, checksum, {file}, {}, nullptr, 0});
+  m_transfers[key] = transfer;
+
+  Path staging = target;
+  staging[staging.size() - 1] += ".download";
+
+  const NetworkOpts &opts = g_reapack->config()->network;
+  FileDownload *dl = new FileDownload(staging, url, opts);
+  dl->setName(target.join());
+  dl->setExpectedChecksum(checksum);
+  dl->setSizeHint(sizeHint);
+  dl->onFinishAsync >> [=] { distribute(transfer, dl); };
+
+  m_tx->threadPool()->push(dl);
+
+  return file;
+}
+
+void DownloadBroker::distribute(const TransferPtr &transfer,
+  const FileDownload *dl)
+{
+  m_transfers.erase(transfer->key);
+
+  transfer->staging = dl->path().temp();
+  const bool success = dl->state() == ThreadTask::Success;
+
+  std::vector<ThreadTask *> copies;
+
+  for(SharedFile *file : transfer->files) {
+    file->m_source = transfer->staging;
+    file->m_size = dl->size();
+
+    // the download already reported its own error
+    if(!success)
+      file->abort();
+
+    if(file->aborted())
+      m_tx->threadPool()->push(file);
+    else if(!transfer->original)
+      transfer->original = file;
+    else
+      copies.push_back(file);
+  }
+
+  if(!transfer->original) {
+    FS::remove(transfer->staging);
+    return;
+  }
+
+  // keep a copy of the verified file for future installations
+  if(g_reapack->config()->install.storeSize) {
+    if(FileCopy *copy = m_tx->store()->add(transfer->staging, transfer->checksum))
+      copies.push_back(copy);
+  }
+
+  transfer->pendingCopies = copies.size();
+
+  if(copies.empty())
+    pushOriginal(transfer);
+  else {
+    for(ThreadTask *copy : copies)
+      pushCopy(copy, transfer);
+  }
+}
+
+void DownloadBroker::pushCopy(ThreadTask *copy, const TransferPtr &transfer)
+{
+  copy->onFinishAsync >> [=] {
+    if(--transfer->pendingCopies == 0)
+      pushOriginal(transfer);
+  };
+
+  m_tx->threadPool()->push(copy);
+}
+
+void DownloadBroker::pushOriginal(const TransferPtr &transfer)
+{
+  SharedFile *file = transfer->original;
+  const Path staging = transfer->staging;
+
+  file->m_move = true;
+
+  // the package may have been rolled back while the copies were running
+  file->onFinishAsync >> [=] {
+    if(file->state() != ThreadTask::Success)
+      FS::remove(staging);
+  };
+
+  m_tx->threadPool()->push(file);
+}
@@ -0,0 +1,83 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_BROKER_HPP
+#define REAPACK_BROKER_HPP
+
+#include "path.hpp"
+#include "thread.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FileDownload;
+class Transaction;
+
+// Receives the file downloaded on behalf of a package, copied (or moved when
+// no other package still needs it) from the shared staging file.
+class SharedFile : public ThreadTask {
+public:
+  SharedFile(const Path &target);
+
+  const TempPath &path() const { return m_path; }
+  int64_t size() const { return m_size; }
+
+  bool concurrent() const override { return true; }
+  bool run() override;
+
+private:
+  friend class DownloadBroker;
+
+  TempPath m_path;
+  Path m_source;
+  bool m_move;
+  int64_t m_size;
+};
+
+// Lets the packages of a transaction requesting the same file (same URL and
+// expected checksum) share a single transfer.
+class DownloadBroker {
+public:
+  DownloadBroker(Transaction *);
+
+  // the returned task is pushed to the thread pool once the download is done
+  SharedFile *fetch(const std::string &url, const std::string &checksum,
+    const Path &target, int64_t sizeHint);
+
+private:
+  struct Transfer {
+    std::string key;
+    std::string checksum;
+    std::vector<SharedFile *> files;
+    Path staging;
+    SharedFile *original;
+    size_t pendingCopies;
+  };
+
+  typedef std::shared_ptr<Transfer> TransferPtr;
+
+  void distribute(const TransferPtr &, const FileDownload *);
+  void pushCopy(ThreadTask *, const TransferPtr &);
+  void pushOriginal(const TransferPtr &);
+
+  Transaction *m_tx;
+  std::map<std::string, TransferPtr> m_transfers;
+};
+
+#endif
@@ -91,12 +91,12 @@ std::string Browser::Entry::displayState() const
 
 const std::string &Browser::Entry::indexName() const
 {
-  return package ? package->category()->index()->name() : regEntry.remote;
+  return package ? package->category()->index()->name() : regEntry.remote.str();
 }
 
 const std::string &Browser::Entry::categoryName() const
 {
-  return package ? package->category()->name() : regEntry.category;
+  return package ? package->category()->name() : regEntry.category.str();
 }
 
 const std::string &Browser::Entry::packageName() const
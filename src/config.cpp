@@ -21,8 +21,10 @@
 #include "win32.hpp"
 
 #include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/logic/tribool_io.hpp> // required to get correct tribool casts
+#include <sstream>
 
 #ifdef _WIN32
 #  include <windows.h>
@@ -37,6 +39,7 @@ static const char *INSTALL_GRP = "install";
 static const char *AUTOINSTALL_KEY = "autoinstall";
 static const char *PRERELEASES_KEY = "prereleases";
 static const char *PROMPTOBSOLETE_KEY = "promptobsolete";
+static const char *STORESIZE_KEY = "storesize";
 
 static const char *ABOUT_GRP = "about";
 static const char *MANAGER_GRP = "manager";
@@ -50,6 +53,8 @@ static const char *PROXY_KEY = "proxy";
 static const char *VERIFYPEER_KEY = "verifypeer";
 static const char *STALETHRSH_KEY = "stalethreshold";
 static const char *FALLBACK_PROXY_KEY = "fallbackproxy";
+static const char *MAXCONNS_KEY = "maxconnections";
+static const char *HOSTCONNS_KEY = "hostconnections";
 
 static const char *SIZE_KEY = "size";
 
@@ -75,8 +80,9 @@ Config::~Config()
 
 void Config::resetOptions()
 {
-  install = {false, false, true};
-  network = {"", true, NetworkOpts::OneWeekThreshold, boost::logic::indeterminate};
+  install = {false, false, true, 256};
+  network = {"", true, NetworkOpts::OneWeekThreshold,
+    boost::logic::indeterminate, 0, {}};
   filter  = {true};
   windowState = {};
 }
@@ -150,6 +156,7 @@ void Config::read()
   install.autoInstall = getBool(INSTALL_GRP, AUTOINSTALL_KEY, install.autoInstall);
   install.bleedingEdge = getBool(INSTALL_GRP, PRERELEASES_KEY, install.bleedingEdge);
   install.promptObsolete = getBool(INSTALL_GRP, PROMPTOBSOLETE_KEY, install.promptObsolete);
+  install.storeSize = getUInt(INSTALL_GRP, STORESIZE_KEY, install.storeSize);
 
   network.proxy = getString(NETWORK_GRP, PROXY_KEY, network.proxy);
   network.verifyPeer = getBool(NETWORK_GRP, VERIFYPEER_KEY, network.verifyPeer);
@@ -157,6 +164,8 @@ void Config::read()
     STALETHRSH_KEY, static_cast<unsigned int>(network.staleThreshold)));
   network.fallbackProxy = boost::lexical_cast<boost::logic::tribool>(getUInt(
     NETWORK_GRP, FALLBACK_PROXY_KEY, 2));
+  network.maxConnections = getUInt(NETWORK_GRP, MAXCONNS_KEY, network.maxConnections);
+  network.parseHostConnections(getString(NETWORK_GRP, HOSTCONNS_KEY));
 
   filter.expandSynonyms = getBool(BROWSER_GRP, SYNONYMS_KEY, filter.expandSynonyms);
 
@@ -176,6 +185,7 @@ void Config::write()
   setUInt(INSTALL_GRP, AUTOINSTALL_KEY, install.autoInstall);
   setUInt(INSTALL_GRP, PRERELEASES_KEY, install.bleedingEdge);
   setUInt(INSTALL_GRP, PROMPTOBSOLETE_KEY, install.promptObsolete);
+  setUInt(INSTALL_GRP, STORESIZE_KEY, install.storeSize);
 
   setString(NETWORK_GRP, PROXY_KEY, network.proxy);
   setUInt(NETWORK_GRP, VERIFYPEER_KEY, network.verifyPeer);
@@ -184,6 +194,8 @@ void Config::write()
     setUInt(NETWORK_GRP, FALLBACK_PROXY_KEY,
       boost::lexical_cast<unsigned int>(network.fallbackProxy));
   }
+  setUInt(NETWORK_GRP, MAXCONNS_KEY, network.maxConnections);
+  setString(NETWORK_GRP, HOSTCONNS_KEY, network.formatHostConnections());
 
   setUInt(BROWSER_GRP, SYNONYMS_KEY, filter.expandSynonyms);
 
@@ -255,3 +267,39 @@ void Config::cleanupArray(const char *group, const char *key,
   for(unsigned int i = begin; i < end; i++)
     deleteKey(group, nKey(key, i).c_str());
 }
+
+void NetworkOpts::parseHostConnections(const std::string &value)
+{
+  std::istringstream stream(value);
+  std::string pair;
+
+  hostConnections.clear();
+
+  while(stream >> pair) {
+    const size_t equal = pair.find('=');
+    if(equal == std::string::npos)
+      continue;
+
+    // match the lowercase host names the downloads are limited by
+    std::string host = pair.substr(0, equal);
+    boost::algorithm::to_lower(host);
+
+    try {
+      hostConnections[host] = std::stoul(pair.substr(equal + 1));
+    }
+    catch(const std::logic_error &) {}
+  }
+}
+
+std::string NetworkOpts::formatHostConnections() const
+{
+  std::ostringstream stream;
+
+  for(const auto &[host, limit] : hostConnections) {
+    if(stream.tellp() > 0)
+      stream << ' ';
+    stream << host << '=' << limit;
+  }
+
+  return stream.str();
+}
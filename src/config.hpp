@@ -20,6 +20,7 @@
 
 #include "remote.hpp"
 
+#include <map>
 #include <string>
 
 class Path;
@@ -34,6 +35,7 @@ struct InstallOpts {
   bool autoInstall;
   bool bleedingEdge;
   bool promptObsolete;
+  unsigned int storeSize; // MiB of downloaded files to keep, 0 to disable
 };
 
 struct NetworkOpts {
@@ -46,6 +48,12 @@ struct NetworkOpts {
   bool verifyPeer;
   time_t staleThreshold;
   boost::logic::tribool fallbackProxy;
+  unsigned int maxConnections; // 0 for the default
+  std::map<std::string, unsigned int> hostConnections;
+
+  // "host=limit" pairs separated by spaces
+  void parseHostConnections(const std::string &);
+  std::string formatHostConnections() const;
 };
 
 struct FilterOpts {
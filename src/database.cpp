@@ -22,16 +22,30 @@
 #include <cinttypes>
 #include <sqlite3.h>
 
-Database::Database(const std::string &fn)
+// how long to retry when another connection holds a conflicting lock
+static const int BUSY_TIMEOUT = 5000; // ms
+
+Database::Database(const std::string &fn, const int flags)
   : m_savePoint(0)
 {
-  if(sqlite3_open(fn.empty() ? ":memory:" : fn.c_str(), &m_db)) {
+  const int openFlags = flags & ReadOnlyFlag ?
+    SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+
+  if(sqlite3_open_v2(fn.empty() ? ":memory:" : fn.c_str(), &m_db, openFlags, nullptr)) {
     const auto &error = lastError();
     sqlite3_close(m_db);
 
     throw error;
   }
 
+  sqlite3_busy_timeout(m_db, BUSY_TIMEOUT);
+
+  // Readers don't wait for the writer (and vice-versa) in write-ahead log
+  // mode. The setting is persistent, failing to enable it (eg. on a network
+  // share) is not fatal.
+  if(!(flags & ReadOnlyFlag))
+    sqlite3_exec(m_db, "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr);
+
   exec("PRAGMA foreign_keys = 1");
 }
 
@@ -155,6 +169,13 @@ void Statement::bind(const int index, const int64_t integer)
     throw m_db->lastError();
 }
 
+void Statement::bindBlob(const int index, const std::string &data)
+{
+  if(sqlite3_bind_blob(m_stmt, index, data.data(),
+      static_cast<int>(data.size()), SQLITE_TRANSIENT))
+    throw m_db->lastError();
+}
+
 void Statement::exec()
 {
   exec([=] { return false; });
@@ -194,3 +215,15 @@ std::string Statement::stringColumn(const int index) const
   else
     return {};
 }
+
+std::string Statement::blobColumn(const int index) const
+{
+  const void *col = sqlite3_column_blob(m_stmt, index);
+
+  if(col) {
+    const int size = sqlite3_column_bytes(m_stmt, index);
+    return {static_cast<const char *>(col), static_cast<size_t>(size)};
+  }
+  else
+    return {};
+}
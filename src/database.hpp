@@ -44,7 +44,11 @@ public:
     }
   };
 
-  Database(const std::string &filename = {});
+  enum Flag {
+    ReadOnlyFlag = 1<<0,
+  };
+
+  Database(const std::string &filename = {}, int flags = 0);
   ~Database();
 
   Statement *prepare(const char *sql);
@@ -79,12 +83,14 @@ public:
 
   void bind(int index, const std::string &text);
   void bind(int index, int64_t integer);
+  void bindBlob(int index, const std::string &data);
   void exec();
   void exec(const ExecCallback &);
 
   int64_t intColumn(int index) const;
   bool boolColumn(int index) const { return intColumn(index) != 0; }
   std::string stringColumn(int index) const;
+  std::string blobColumn(int index) const;
 
 private:
   friend Database;
@@ -22,14 +22,32 @@
 #include "hash.hpp"
 #include "reapack.hpp"
 #include "win32.hpp"
+#include "xml.hpp"
 
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
 #include <cassert>
+#include <cstring>
+#include <random>
 
 #include <reaper_plugin_functions.h>
 
 static const int DOWNLOAD_TIMEOUT = 15;
-// to set the amount of concurrent downloads, change the size of
-// the m_pool member in ThreadPool (thread.hpp)
+// milliseconds to wait for network activity before checking for aborted tasks
+static const int POLL_TIMEOUT = 1000;
+static const int PROXY_POLL_TIMEOUT = 100;
+// total amount of tries for downloads failing with a transient error
+static const size_t MAX_ATTEMPTS = 4;
+// delay before the first retry, doubled after each subsequent attempt
+static const std::chrono::milliseconds RETRY_DELAY(1000);
+static const std::chrono::seconds MAX_RETRY_AFTER(60);
+// minimum time between two DownloadThread::onProgress
+static const std::chrono::milliseconds PROGRESS_INTERVAL(250);
+
+static const std::string PROXY_URL = "https://raw.reapack.com/usercontent?";
+static const std::string PROXY_HOST = "raw.reapack.com";
 
 static CURLSH *g_curlShare = nullptr;
 static std::mutex g_curlMutex;
@@ -82,6 +100,7 @@ DownloadContext::DownloadContext()
   curl_easy_setopt(m_curl, CURLOPT_FAILONERROR, true);
   curl_easy_setopt(m_curl, CURLOPT_SHARE, g_curlShare);
   curl_easy_setopt(m_curl, CURLOPT_NOPROGRESS, false);
+  curl_easy_setopt(m_curl, CURLOPT_PIPEWAIT, true);
 #ifdef CURLSSLOPT_REVOKE_BEST_EFFORT
   curl_easy_setopt(m_curl, CURLOPT_SSL_OPTIONS, CURLSSLOPT_REVOKE_BEST_EFFORT);
 #endif
@@ -92,27 +111,400 @@ DownloadContext::~DownloadContext()
   curl_easy_cleanup(m_curl);
 }
 
+DownloadThread::DownloadThread()
+  : m_multi(curl_multi_init()), m_configured(false), m_stop(false),
+    m_received(0), m_expected(0), m_progressPending(false),
+    m_reportedReceived(0), m_reportedExpected(0)
+{
+  m_progressAsync >> [this](const int64_t received, const int64_t expected) {
+    m_progressPending = false;
+    onProgress(received, expected);
+  };
+
+  m_thread = std::thread(&DownloadThread::run, this);
+}
+
+DownloadThread::~DownloadThread()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_stop = true;
+  }
+
+  wakeUp();
+  m_thread.join();
+
+  // unfinished transfers are left alone, just like the tasks still queued
+  // in a WorkerThread when its pool is destroyed
+  for(Download *dl : m_active)
+    curl_multi_remove_handle(m_multi, *dl->m_ctx);
+
+  curl_multi_cleanup(m_multi);
+}
+
+void DownloadThread::push(Download *dl)
+{
+  dl->m_downloadThread = this;
+  dl->m_reportedExpected = dl->sizeHint();
+  m_expected += dl->sizeHint();
+
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_queue.push_back(dl);
+  }
+
+  wakeUp();
+}
+
+void DownloadThread::wakeUp()
+{
+  curl_multi_wakeup(m_multi);
+}
+
+void DownloadThread::run()
+{
+  curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+  while(true) {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if(m_stop)
+        break;
+    }
+
+    cancelAborted();
+    processProxyRequests();
+    processRetries();
+    startQueued();
+
+    int running;
+    curl_multi_perform(m_multi, &running);
+
+    reportProgress();
+
+    // don't wait for network activity if finished transfers freed a slot
+    if(processMessages())
+      continue;
+
+    curl_multi_poll(m_multi, nullptr, 0, pollTimeout(), nullptr);
+  }
+}
+
+void DownloadThread::startQueued()
+{
+  while(true) {
+    Download *dl = nullptr;
+
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+
+      if(m_queue.empty())
+        return;
+
+      // every download of a pool shares the same settings
+      if(!m_configured) {
+        m_limiter.configure(m_queue.front()->m_opts);
+        m_configured = true;
+      }
+
+      // start the largest download first to minimize the total time,
+      // skipping over those from hosts that are already busy
+      auto it = m_queue.end();
+      for(auto qit = m_queue.begin(); qit != m_queue.end(); ++qit) {
+        Download *queued = *qit;
+
+        if(queued->aborted()) {
+          it = qit;
+          break;
+        }
+        else if(m_limiter.available(queued->host()) &&
+            (it == m_queue.end() || queued->sizeHint() > (*it)->sizeHint()))
+          it = qit;
+      }
+
+      if(it == m_queue.end())
+        return;
+
+      dl = *it;
+      m_queue.erase(it);
+    }
+
+    if(dl->start())
+      transfer(dl);
+    else
+      dl->finish(false);
+  }
+}
+
+void DownloadThread::transfer(Download *dl)
+{
+  if(CURL *handle = dl->startTransfer()) {
+    curl_multi_add_handle(m_multi, handle);
+    m_active.push_back(dl);
+    m_limiter.acquire(dl->host());
+  }
+  else
+    dl->finish(false);
+}
+
+void DownloadThread::remove(Download *dl)
+{
+  curl_multi_remove_handle(m_multi, *dl->m_ctx);
+  m_active.erase(std::find(m_active.begin(), m_active.end(), dl));
+}
+
+bool DownloadThread::processMessages()
+{
+  bool finished = false;
+  int remaining;
+
+  while(CURLMsg *msg = curl_multi_info_read(m_multi, &remaining)) {
+    if(msg->msg != CURLMSG_DONE)
+      continue;
+
+    // msg is freed when the handle is removed from m_multi
+    const CURLcode result = msg->data.result;
+    Download *dl;
+    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &dl);
+    remove(dl);
+
+    const Download::TransferResult transferResult = dl->finishTransfer(result);
+
+    // the slot must be released before finish() hands the task back
+    // to the main thread, which may delete it at any time afterwards
+    switch(transferResult) {
+    case Download::TransferSuccess: {
+      curl_off_t speed = 0;
+      curl_easy_getinfo(*dl->m_ctx, CURLINFO_SPEED_DOWNLOAD_T, &speed);
+      m_limiter.succeeded(dl->host(), static_cast<double>(speed));
+      break;
+    }
+    case Download::TransferNeedsProxy:
+    case Download::TransferRetry:
+      m_limiter.congested(dl->host());
+      break;
+    default:
+      m_limiter.release(dl->host());
+      break;
+    }
+
+    switch(transferResult) {
+    case Download::TransferSuccess:
+      dl->finish(true);
+      break;
+    case Download::TransferFailure:
+      dl->finish(false);
+      break;
+    case Download::TransferNeedsProxy:
+      // wait for the answer without blocking the other transfers
+      m_proxyRequests.push_back({dl, dl->onRequestProxyAsync()});
+      break;
+    case Download::TransferRestart:
+      transfer(dl);
+      break;
+    case Download::TransferRetry:
+      // the transfer slot is given to the next queued download meanwhile
+      m_retries.push_back({
+        std::chrono::steady_clock::now() + dl->m_retryDelay, dl});
+      break;
+    }
+
+    finished = true;
+  }
+
+  return finished;
+}
+
+void DownloadThread::processProxyRequests()
+{
+  for(auto it = m_proxyRequests.begin(); it != m_proxyRequests.end();) {
+    if(it->answer.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      ++it;
+      continue;
+    }
+
+    Download *dl = it->download;
+    const bool useProxy = it->answer.get().value_or(false);
+    it = m_proxyRequests.erase(it);
+
+    if(useProxy && !dl->aborted()) {
+      dl->useProxy();
+      transfer(dl);
+    }
+    else
+      dl->finish(false);
+  }
+}
+
+void DownloadThread::processRetries()
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  for(auto it = m_retries.begin(); it != m_retries.end();) {
+    if(it->time > now || !m_limiter.available(it->download->host())) {
+      ++it;
+      continue;
+    }
+
+    Download *dl = it->download;
+    it = m_retries.erase(it);
+    transfer(dl);
+  }
+}
+
+int DownloadThread::pollTimeout() const
+{
+  int timeout = m_proxyRequests.empty() ? POLL_TIMEOUT : PROXY_POLL_TIMEOUT;
+
+  // keep reporting while transfers are stalled
+  if(!m_active.empty() || progressChanged())
+    timeout = std::min<int>(timeout, PROGRESS_INTERVAL.count());
+
+  const auto now = std::chrono::steady_clock::now();
+  for(const PendingRetry &retry : m_retries) {
+    const long long wait = std::chrono::duration_cast<
+      std::chrono::milliseconds>(retry.time - now).count();
+
+    // retries already due are waiting for a transfer to finish
+    if(wait > 0)
+      timeout = std::min<long long>(wait, timeout);
+  }
+
+  return timeout;
+}
+
+bool DownloadThread::progressChanged() const
+{
+  return m_received != m_reportedReceived || m_expected != m_reportedExpected;
+}
+
+void DownloadThread::reportProgress()
+{
+  const auto now = std::chrono::steady_clock::now();
+  if(now - m_lastProgress < PROGRESS_INTERVAL ||
+      (m_active.empty() && !progressChanged()))
+    return;
+
+  // skip this update if the main thread didn't process the previous one yet
+  if(m_progressPending.exchange(true))
+    return;
+
+  m_lastProgress = now;
+  m_reportedReceived = m_received;
+  m_reportedExpected = m_expected;
+  m_progressAsync(m_reportedReceived, m_reportedExpected);
+}
+
+void DownloadThread::cancelAborted()
+{
+  for(auto it = m_retries.begin(); it != m_retries.end();) {
+    if(it->download->aborted()) {
+      it->download->finish(false);
+      it = m_retries.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  for(size_t i = 0; i < m_active.size();) {
+    Download *dl = m_active[i];
+
+    if(!dl->aborted()) {
+      ++i;
+      continue;
+    }
+
+    remove(dl);
+    m_limiter.release(dl->host());
+    dl->finishTransfer(CURLE_ABORTED_BY_CALLBACK);
+    dl->finish(false);
+  }
+}
+
 size_t Download::WriteData(char *data, size_t rawsize, size_t nmemb, void *ptr)
+{
+  const size_t size = rawsize * nmemb;
+  Download *dl = static_cast<Download *>(ptr);
+
+  if(!dl->m_write.size && !dl->checkRange())
+    return 0; // don't append the full response to the partial file
+
+  dl->m_write.write(data, size);
+  dl->received(data, size);
+
+  return size;
+}
+
+size_t Download::ReadHeader(char *data, size_t rawsize, size_t nmemb, void *ptr)
 {
   const size_t size = rawsize * nmemb;
 
-  static_cast<WriteContext *>(ptr)->write(data, size);
+  static_cast<Download *>(ptr)->readHeader({data, size});
 
   return size;
 }
 
-int Download::UpdateProgress(void *ptr, const double, const double,
-    const double, const double)
+int Download::UpdateProgress(void *ptr, const curl_off_t dltotal,
+    const curl_off_t dlnow, const curl_off_t, const curl_off_t)
 {
-  return static_cast<Download *>(ptr)->aborted();
+  Download *dl = static_cast<Download *>(ptr);
+  dl->updateProgress(dlnow, dltotal);
+  return dl->aborted();
+}
+
+void Download::updateProgress(const int64_t now, const int64_t total)
+{
+  if(!m_downloadThread)
+    return;
+
+  // only report the difference so that every transfer can add to the same
+  // counters without locking (the numbers go back down on restart)
+  const int64_t received = m_resumeOffset + now;
+  m_downloadThread->m_received += received - m_reportedReceived;
+  m_reportedReceived = received;
+
+  if(total > 0) {
+    const int64_t expected = m_resumeOffset + total;
+    m_downloadThread->m_expected += expected - m_reportedExpected;
+    m_reportedExpected = expected;
+  }
+}
+
+static std::string hostOf(const std::string &url)
+{
+  size_t begin = url.find("://");
+  begin = begin == std::string::npos ? 0 : begin + 3;
+
+  const size_t end = url.find_first_of("/?#", begin);
+  std::string host = url.substr(begin, end - begin);
+
+  if(const size_t userinfo = host.rfind('@'); userinfo != std::string::npos)
+    host.erase(0, userinfo + 1);
+
+  boost::algorithm::to_lower(host);
+  return host;
 }
 
 Download::Download(const std::string &url, const NetworkOpts &opts, const int flags)
-  : m_url(url), m_opts(opts), m_flags(flags)
+  : m_url(url), m_host(hostOf(url)), m_opts(opts), m_flags(flags),
+    m_sizeHint(0), m_proxy(false), m_notModified(false), m_acceptRanges(false),
+    m_encoded(false), m_resumeOffset(0), m_rangeIgnored(false),
+    m_retryDelay(0), m_downloadThread(nullptr), m_reportedReceived(0),
+    m_reportedExpected(0), m_headers(nullptr)
 {
   onRequestProxyAsync >> std::bind(&ReaPack::requestProxy, g_reapack);
 }
 
+Download::~Download()
+{
+  curl_slist_free_all(m_headers);
+}
+
+const std::string &Download::host() const
+{
+  return m_proxy ? PROXY_HOST : m_host;
+}
+
 void Download::setName(const std::string &name)
 {
   setSummary({ "Downloading", name });
@@ -131,30 +523,69 @@ static bool isGitHub(const std::string &url)
   return false;
 }
 
-bool Download::run(const bool proxy)
+bool Download::run()
+{
+  while(true) {
+    CURL *handle = startTransfer();
+    if(!handle)
+      return false;
+
+    switch(finishTransfer(curl_easy_perform(handle))) {
+    case TransferSuccess:
+      return true;
+    case TransferFailure:
+      return false;
+    case TransferNeedsProxy:
+      if(!onRequestProxyAsync().get().value_or(false))
+        return false;
+      useProxy();
+      break;
+    case TransferRestart:
+      break;
+    case TransferRetry: {
+      const auto until = std::chrono::steady_clock::now() + m_retryDelay;
+      while(!aborted() && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(PROXY_POLL_TIMEOUT));
+      if(aborted())
+        return false;
+      break;
+    }
+    }
+  }
+}
+
+CURL *Download::startTransfer()
 {
-  WriteContext write;
+  m_write = {};
+  m_responseValidators = {};
+  m_acceptRanges = m_encoded = false;
+  m_resumeOffset = 0;
+  m_ifRange = {};
+  m_rangeIgnored = false;
 
   Hash::Algorithm algo;
   if(!m_expectedChecksum.empty()) {
     if(Hash::getAlgorithm(m_expectedChecksum, &algo))
-      write.hash = std::make_unique<Hash>(algo);
+      m_write.hash = std::make_unique<Hash>(algo);
     else {
       const std::string &error = String::format(
         "Unsupported checksum: %s", m_expectedChecksum.c_str());
       setError({error, m_url});
-      return false;
+      return nullptr;
     }
   }
 
-  if(!(write.stream = openStream()))
-    return false;
+  if(!(m_write.stream = openStream()))
+    return nullptr;
 
-  thread_local DownloadContext ctx;
+  if(!m_ctx)
+    m_ctx = std::make_unique<DownloadContext>();
+
+  DownloadContext &ctx = *m_ctx;
 
   std::string url = m_url;
-  if(proxy)
-    url.insert(0, "https://raw.reapack.com/usercontent?");
+  if(m_proxy)
+    url.insert(0, PROXY_URL);
 
   curl_easy_setopt(ctx, CURLOPT_URL, url.c_str());
   curl_easy_setopt(ctx, CURLOPT_PROXY, m_opts.proxy.c_str());
@@ -163,60 +594,330 @@ bool Download::run(const bool proxy)
   curl_easy_setopt(ctx, CURLOPT_CAINFO, nullptr);
 #endif
 
-  curl_easy_setopt(ctx, CURLOPT_PROGRESSFUNCTION, UpdateProgress);
-  curl_easy_setopt(ctx, CURLOPT_PROGRESSDATA, this);
+  curl_easy_setopt(ctx, CURLOPT_PRIVATE, this);
+
+  curl_easy_setopt(ctx, CURLOPT_XFERINFOFUNCTION, UpdateProgress);
+  curl_easy_setopt(ctx, CURLOPT_XFERINFODATA, this);
 
   curl_easy_setopt(ctx, CURLOPT_WRITEFUNCTION, WriteData);
-  curl_easy_setopt(ctx, CURLOPT_WRITEDATA, &write);
+  curl_easy_setopt(ctx, CURLOPT_WRITEDATA, this);
+
+  curl_easy_setopt(ctx, CURLOPT_HEADERFUNCTION, ReadHeader);
+  curl_easy_setopt(ctx, CURLOPT_HEADERDATA, this);
 
-  curl_slist *headers = nullptr;
   if(has(Download::NoCacheFlag))
-    headers = curl_slist_append(headers, "Cache-Control: no-cache");
-  if(proxy)
-    headers = curl_slist_append(headers, "X-ReaPack-Proxy: 1");
-  curl_easy_setopt(ctx, CURLOPT_HTTPHEADER, headers);
+    m_headers = curl_slist_append(m_headers, "Cache-Control: no-cache");
+  if(!m_validators.etag.empty()) {
+    m_headers = curl_slist_append(m_headers,
+      ("If-None-Match: " + m_validators.etag).c_str());
+  }
+  if(!m_validators.lastModified.empty()) {
+    m_headers = curl_slist_append(m_headers,
+      ("If-Modified-Since: " + m_validators.lastModified).c_str());
+  }
+  if(m_proxy)
+    m_headers = curl_slist_append(m_headers, "X-ReaPack-Proxy: 1");
 
-  std::string errbuf = "No error message";
-  errbuf.resize(CURL_ERROR_SIZE - 1, '\0');
-  curl_easy_setopt(ctx, CURLOPT_ERRORBUFFER, errbuf.data());
+  // byte ranges apply to the encoded representation: don't ask for
+  // compression when resuming so the partial file stays usable as-is
+  curl_easy_setopt(ctx, CURLOPT_RESUME_FROM_LARGE,
+    static_cast<curl_off_t>(m_resumeOffset));
+  curl_easy_setopt(ctx, CURLOPT_ACCEPT_ENCODING, m_resumeOffset ? nullptr : "");
+  if(m_resumeOffset) {
+    const std::string &validator = m_ifRange.etag.empty() ?
+      m_ifRange.lastModified : m_ifRange.etag;
+    m_headers = curl_slist_append(m_headers, ("If-Range: " + validator).c_str());
+  }
+
+  curl_easy_setopt(ctx, CURLOPT_HTTPHEADER, m_headers);
+
+  m_errbuf = "No error message";
+  m_errbuf.resize(CURL_ERROR_SIZE - 1, '\0');
+  curl_easy_setopt(ctx, CURLOPT_ERRORBUFFER, m_errbuf.data());
+
+  return ctx;
+}
 
-  const CURLcode res = curl_easy_perform(ctx);
-  curl_slist_free_all(headers);
+Download::TransferResult Download::finishTransfer(const CURLcode res)
+{
+  curl_slist_free_all(m_headers);
+  m_headers = nullptr;
   closeStream();
+  collectStats();
+
+  long status = 0;
+  curl_easy_getinfo(*m_ctx, CURLINFO_RESPONSE_CODE, &status);
+
+  // the server refused the range or the file changed since the last attempt
+  if(m_resumeOffset &&
+      (m_rangeIgnored || res == CURLE_RANGE_ERROR || status == 416))
+    return TransferRestart;
 
   if(res != CURLE_OK) {
-    if(!proxy && isGitHub(m_url)) {
-      long status = 0;
-      curl_easy_getinfo(ctx, CURLINFO_RESPONSE_CODE, &status);
-      if(status == 429 && *(onRequestProxyAsync().get()))
-        return run(true);
+    if(m_write.size) {
+      const Validators &ifRange = resumeValidators();
+      if(!ifRange.empty())
+        keepPartial(ifRange);
     }
 
+    const bool needsProxy = !m_proxy && status == 429 && isGitHub(m_url);
+
 #ifdef _WIN32
-    errbuf = Win32::ansi2utf8(errbuf);
+    const std::string &errbuf = Win32::ansi2utf8(m_errbuf);
+#else
+    const std::string &errbuf = m_errbuf;
 #endif
 
     const std::string &err = String::format(
       "%s (%d): %s%s", curl_easy_strerror(res), res, errbuf.c_str(),
-      proxy ? " [proxied]" : "");
-    setError({err, m_url});
-    return false;
+      m_proxy ? " [proxied]" : "");
+
+    if(needsProxy) {
+      setError({err, m_url, m_attempts});
+      return TransferNeedsProxy;
+    }
+    else if(scheduleRetry(res, status, err))
+      return TransferRetry;
+
+    setError({err, m_url, m_attempts});
+    return TransferFailure;
   }
-  else if(write.hash && write.hash->digest() != m_expectedChecksum) {
+
+  if(status == 304) {
+    m_notModified = true;
+    return TransferSuccess;
+  }
+  else if(m_write.hash && m_write.hash->digest() != m_expectedChecksum) {
     const std::string &err = String::format(
       "Checksum mismatch.\nExpected: %s\nActual: %s",
-      m_expectedChecksum.c_str(), write.hash->digest().c_str()
+      m_expectedChecksum.c_str(), m_write.hash->digest().c_str()
     );
-    setError({err, m_url});
+    setError({err, m_url, m_attempts});
+    return TransferFailure;
+  }
+
+  m_validators = m_responseValidators;
+  completed();
+
+  return TransferSuccess;
+}
+
+void Download::collectStats()
+{
+  CURL *handle = *m_ctx;
+  TransferStats stats{host()};
+
+  curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME, &stats.nameLookup);
+  curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME, &stats.connect);
+  curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME, &stats.appConnect);
+  curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &stats.startTransfer);
+  curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &stats.total);
+
+  curl_off_t size = 0;
+  curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &size);
+  stats.size = size;
+
+  long connects = 0;
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+  stats.reused = connects == 0;
+
+  long version = 0;
+  curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+  switch(version) {
+  case CURL_HTTP_VERSION_1_0:
+    stats.httpVersion = "1.0";
+    break;
+  case CURL_HTTP_VERSION_1_1:
+    stats.httpVersion = "1.1";
+    break;
+  case CURL_HTTP_VERSION_2_0:
+    stats.httpVersion = "2";
+    break;
+  case CURL_HTTP_VERSION_3:
+    stats.httpVersion = "3";
+    break;
+  }
+
+  addTransfer(stats);
+}
+
+static bool isTransient(const CURLcode res, const long status)
+{
+  switch(res) {
+  case CURLE_COULDNT_CONNECT:
+  case CURLE_OPERATION_TIMEDOUT: // includes the low speed limit
+  case CURLE_SEND_ERROR:
+  case CURLE_RECV_ERROR:
+  case CURLE_PARTIAL_FILE:
+  case CURLE_GOT_NOTHING:
+  case CURLE_SSL_CONNECT_ERROR:
+  case CURLE_HTTP2:
+  case CURLE_HTTP2_STREAM:
+    return true;
+  case CURLE_HTTP_RETURNED_ERROR:
+    switch(status) {
+    case 408: // Request Timeout
+    case 425: // Too Early
+    case 429: // Too Many Requests
+    case 500: // Internal Server Error
+    case 502: // Bad Gateway
+    case 503: // Service Unavailable
+    case 504: // Gateway Timeout
+      return true;
+    default:
+      return false;
+    }
+  default:
+    return false;
+  }
+}
+
+bool Download::scheduleRetry(const CURLcode res, const long status,
+  const std::string &error)
+{
+  if(aborted() || !isTransient(res, status) ||
+      m_attempts.size() + 1 >= MAX_ATTEMPTS)
     return false;
+
+  curl_off_t retryAfter = 0;
+  curl_easy_getinfo(*m_ctx, CURLINFO_RETRY_AFTER, &retryAfter);
+
+  if(retryAfter > MAX_RETRY_AFTER.count())
+    return false; // not worth holding the transaction for that long
+  else if(retryAfter > 0)
+    m_retryDelay = std::chrono::seconds(retryAfter);
+  else {
+    // exponential backoff with jitter so that transfers failing together
+    // (eg. after a dropped connection) don't all come back at once
+    static thread_local std::minstd_rand rng(std::random_device{}());
+
+    const auto backoff = RETRY_DELAY * (1 << m_attempts.size());
+    std::uniform_int_distribution<long long> jitter(0, backoff.count() / 2);
+    m_retryDelay = backoff / 2 + std::chrono::milliseconds(jitter(rng));
   }
 
+  m_attempts.push_back(error);
+
   return true;
 }
 
+void Download::readHeader(std::string_view line)
+{
+  if(boost::algorithm::starts_with(line, "HTTP/")) {
+    // status line of a new response (eg. after following a redirection)
+    m_responseValidators = {};
+    m_acceptRanges = m_encoded = false;
+    return;
+  }
+
+  const size_t colon = line.find(':');
+  if(colon == std::string_view::npos)
+    return;
+
+  const std::string_view &name = line.substr(0, colon);
+  const std::string &value = boost::algorithm::trim_copy(
+    std::string{line.substr(colon + 1)});
+
+  if(boost::algorithm::iequals(name, "ETag"))
+    m_responseValidators.etag = value;
+  else if(boost::algorithm::iequals(name, "Last-Modified"))
+    m_responseValidators.lastModified = value;
+  else if(boost::algorithm::iequals(name, "Accept-Ranges"))
+    m_acceptRanges = boost::algorithm::iequals(value, "bytes");
+  else if(boost::algorithm::iequals(name, "Content-Encoding"))
+    m_encoded = !value.empty() && !boost::algorithm::iequals(value, "identity");
+}
+
+bool Download::checkRange()
+{
+  if(!m_resumeOffset)
+    return true;
+
+  long status = 0;
+  curl_easy_getinfo(*m_ctx, CURLINFO_RESPONSE_CODE, &status);
+  m_rangeIgnored = status != 206;
+
+  return !m_rangeIgnored;
+}
+
+auto Download::resumeValidators() const -> Validators
+{
+  // conditional requests are for small files that are cheap to redownload
+  if(!m_validators.empty() || m_encoded || !(m_acceptRanges || m_resumeOffset))
+    return {};
+
+  // If-Range only accepts strong entity tags
+  const std::string &etag = m_responseValidators.etag;
+  if(!etag.empty() && etag.rfind("W/", 0) != 0)
+    return {etag, {}};
+  else if(!m_responseValidators.lastModified.empty())
+    return {{}, m_responseValidators.lastModified};
+  else
+    return {};
+}
+
+void Download::resume(std::istream &prefix, const Validators &ifRange)
+{
+  char buffer[8192];
+
+  while(prefix) {
+    prefix.read(buffer, sizeof(buffer));
+    const std::streamsize count = prefix.gcount();
+
+    if(m_write.hash)
+      m_write.hash->addData(buffer, count);
+
+    received(buffer, count);
+    m_resumeOffset += count;
+  }
+
+  m_ifRange = ifRange;
+}
+
+auto Download::Validators::read(const Path &path) -> Validators
+{
+  Validators validators;
+
+  std::ifstream stream;
+  if(!FS::open(stream, path))
+    return validators;
+
+  std::string line;
+  while(std::getline(stream, line)) {
+    const size_t colon = line.find(':');
+    if(colon == std::string::npos)
+      continue;
+
+    const std::string &name = line.substr(0, colon);
+    const std::string &value = boost::algorithm::trim_copy(line.substr(colon + 1));
+
+    if(name == "ETag")
+      validators.etag = value;
+    else if(name == "Last-Modified")
+      validators.lastModified = value;
+  }
+
+  return validators;
+}
+
+bool Download::Validators::write(const Path &path) const
+{
+  if(empty())
+    return FS::remove(path);
+
+  std::ostringstream stream;
+  if(!etag.empty())
+    stream << "ETag: " << etag << '\n';
+  if(!lastModified.empty())
+    stream << "Last-Modified: " << lastModified << '\n';
+
+  return FS::write(path, stream.str());
+}
+
 void Download::WriteContext::write(const char *data, const size_t len)
 {
   stream->write(data, len);
+  size += len;
 
   if(hash)
     hash->addData(data, len);
@@ -237,15 +938,113 @@ FileDownload::FileDownload(const Path &target, const std::string &url,
 
 bool FileDownload::save()
 {
-  if(state() == Success)
+  if(state() == Success && !notModified())
     return FS::rename(m_path);
   else
     return FS::remove(m_path.temp());
 }
 
+static const char *PARTIAL_META = ".http";
+
+static Path partialDir()
+{
+  return Path::DATA + "partial";
+}
+
+void FileDownload::trimPartials(const time_t maxAge, const int64_t maxSize)
+{
+  struct Partial { std::string name; time_t mtime; int64_t size; };
+  std::vector<Partial> partials;
+  std::vector<std::string> metas;
+
+  const Path &dir = partialDir();
+
+  for(std::string &name : FS::list(dir)) {
+    if(boost::algorithm::ends_with(name, PARTIAL_META)) {
+      metas.push_back(std::move(name));
+      continue;
+    }
+
+    Partial partial{std::move(name), 0, 0};
+    const Path &path = dir + partial.name;
+    if(FS::mtime(path, &partial.mtime) && FS::size(path, &partial.size))
+      partials.push_back(std::move(partial));
+  }
+
+  std::sort(partials.begin(), partials.end(),
+    [](const Partial &a, const Partial &b) { return a.mtime > b.mtime; });
+
+  const time_t oldest = time(nullptr) - maxAge;
+  int64_t total = 0;
+
+  for(const Partial &partial : partials) {
+    total += partial.size;
+
+    if(partial.mtime < oldest || total > maxSize) {
+      FS::remove(dir + partial.name);
+      FS::remove(dir + (partial.name + PARTIAL_META));
+    }
+  }
+
+  // metadata of partial files that were removed by other means
+  for(const std::string &meta : metas) {
+    const std::string &name = meta.substr(0, meta.size() - strlen(PARTIAL_META));
+    if(!FS::exists(dir + name))
+      FS::remove(dir + meta);
+  }
+}
+
+Path FileDownload::partialPath(const char *ext) const
+{
+  // the expected checksum ensures a different version of the file
+  // at the same URL is never resumed
+  Hash hash(Hash::SHA256);
+  hash.addData(url().c_str(), url().size());
+  hash.addData(expectedChecksum().c_str(), expectedChecksum().size());
+
+  return partialDir() + (hash.digest() + ext);
+}
+
+bool FileDownload::restorePartial()
+{
+  if(!validators().empty())
+    return false;
+
+  const Path &partial = partialPath(), &meta = partialPath(PARTIAL_META);
+  if(!FS::exists(partial))
+    return false;
+
+  const Validators &ifRange = Validators::read(meta);
+  FS::remove(meta);
+
+  FS::remove(m_path.temp());
+  if(ifRange.empty() || !FS::rename(partial, m_path.temp())) {
+    FS::remove(partial);
+    return false;
+  }
+
+  std::ifstream prefix;
+  if(!FS::open(prefix, m_path.temp()))
+    return false;
+
+  resume(prefix, ifRange);
+  return true;
+}
+
+void FileDownload::keepPartial(const Validators &ifRange)
+{
+  const Path &partial = partialPath();
+
+  FS::remove(partial);
+  if(FS::mkdir(partial.dirname()) && FS::rename(m_path.temp(), partial))
+    ifRange.write(partialPath(PARTIAL_META));
+}
+
 std::ostream *FileDownload::openStream()
 {
-  if(FS::open(m_stream, m_path.temp()))
+  const bool resumed = restorePartial();
+
+  if(FS::open(m_stream, m_path.temp(), resumed))
     return &m_stream;
   else {
     setError({FS::lastError(), m_path.temp().join()});
@@ -257,3 +1056,36 @@ void FileDownload::closeStream()
 {
   m_stream.close();
 }
+
+IndexDownload::IndexDownload(const Path &target, const std::string &url,
+    const NetworkOpts &opts, const int flags)
+  : FileDownload(target, url, opts, flags)
+{
+}
+
+IndexDownload::~IndexDownload() = default;
+
+std::ostream *IndexDownload::openStream()
+{
+  // start over on every attempt, before a partial file is restored
+  m_parser = std::make_unique<XmlParser>();
+  m_document = nullptr;
+
+  return FileDownload::openStream();
+}
+
+void IndexDownload::received(const char *data, const size_t len)
+{
+  m_parser->write(data, len);
+}
+
+std::unique_ptr<XmlDocument> IndexDownload::takeDocument()
+{
+  return std::move(m_document);
+}
+
+void IndexDownload::completed()
+{
+  m_document = std::make_unique<XmlDocument>(m_parser->finish());
+  m_parser.reset();
+}
@@ -19,15 +19,22 @@
 #define REAPACK_DOWNLOAD_HPP
 
 #include "config.hpp"
+#include "limiter.hpp"
 #include "path.hpp"
 #include "thread.hpp"
 
+#include <chrono>
 #include <curl/curl.h>
+#include <deque>
 #include <fstream>
 #include <memory>
 #include <sstream>
+#include <vector>
 
+class Download;
 class Hash;
+class XmlDocument;
+class XmlParser;
 
 class DownloadContext {
 public:
@@ -43,34 +50,133 @@ private:
   CURL *m_curl;
 };
 
+// Drives every transfer of a ThreadPool from a single curl_multi event loop,
+// letting them share connections (and HTTP/2 multiplexing) without
+// occupying a worker thread each.
+class DownloadThread {
+public:
+  DownloadThread();
+  DownloadThread(const DownloadThread &) = delete;
+  ~DownloadThread();
+
+  void push(Download *);
+  void wakeUp();
+
+  // total bytes received and expected, at a bounded rate (main thread)
+  Event<void(int64_t received, int64_t expected)> onProgress;
+
+private:
+  friend Download;
+
+  struct ProxyRequest {
+    Download *download;
+    std::future<std::optional<bool>> answer;
+  };
+
+  struct PendingRetry {
+    std::chrono::steady_clock::time_point time;
+    Download *download;
+  };
+
+  void run();
+  void startQueued();
+  bool processMessages();
+  void processProxyRequests();
+  void processRetries();
+  int pollTimeout() const;
+  void cancelAborted();
+  bool progressChanged() const;
+  void reportProgress();
+  void transfer(Download *);
+  void remove(Download *);
+
+  CURLM *m_multi;
+  ConnectionLimiter m_limiter;
+  bool m_configured;
+  bool m_stop;
+  std::mutex m_mutex;
+  std::deque<Download *> m_queue;
+  std::vector<Download *> m_active;
+  std::vector<ProxyRequest> m_proxyRequests;
+  std::vector<PendingRetry> m_retries;
+
+  // written by the transfer callbacks without locking
+  std::atomic<int64_t> m_received;
+  std::atomic<int64_t> m_expected;
+  std::atomic_bool m_progressPending;
+  std::chrono::steady_clock::time_point m_lastProgress;
+  int64_t m_reportedReceived;
+  int64_t m_reportedExpected;
+  AsyncEvent<void(int64_t, int64_t)> m_progressAsync;
+
+  std::thread m_thread;
+};
+
 class Download : public ThreadTask {
 public:
   enum Flag {
     NoCacheFlag = 1<<0,
   };
 
+  // response headers allowing to revalidate a previously downloaded copy
+  struct Validators {
+    static Validators read(const Path &);
+    bool write(const Path &) const;
+    bool empty() const { return etag.empty() && lastModified.empty(); }
+
+    std::string etag;
+    std::string lastModified;
+  };
+
   Download(const std::string &url, const NetworkOpts &, int flags = 0);
+  ~Download();
 
   void setName(const std::string &);
   void setExpectedChecksum(const std::string &checksum) {
     m_expectedChecksum = checksum;
   }
+  void setValidators(const Validators &v) { m_validators = v; }
+  void setSizeHint(int64_t size) { m_sizeHint = size; }
+  int64_t sizeHint() const { return m_sizeHint; }
   const std::string &url() const { return m_url; }
+  const std::string &host() const;
+  const std::string &expectedChecksum() const { return m_expectedChecksum; }
+  const Validators &validators() const { return m_validators; }
+  bool notModified() const { return m_notModified; }
+  int64_t size() const { return m_resumeOffset + m_write.size; }
 
   bool concurrent() const override { return true; }
-  bool run() override { return run(false); }
-  bool run(bool proxy);
+  bool run() override;
 
   AsyncEvent<bool()> onRequestProxyAsync;
 
 protected:
   virtual std::ostream *openStream() = 0;
   virtual void closeStream() {}
+  // called with the If-Range validator after an interrupted transfer
+  virtual void keepPartial(const Validators &) {}
+  // called in the transfer thread with each chunk of the response body,
+  // including the prefix of a resumed transfer
+  virtual void received(const char *, size_t) {}
+  // called in the transfer thread once the whole body was received
+  virtual void completed() {}
+  void resume(std::istream &prefix, const Validators &);
 
 private:
+  friend DownloadThread;
+
+  enum TransferResult {
+    TransferSuccess,
+    TransferFailure,
+    TransferNeedsProxy,
+    TransferRestart,
+    TransferRetry,
+  };
+
   struct WriteContext {
     std::ostream *stream;
     std::unique_ptr<Hash> hash;
+    int64_t size;
 
     void write(const char *data, size_t len);
     bool checkChecksum(const std::string &expected) const;
@@ -78,12 +184,47 @@ private:
 
   bool has(Flag f) const { return (m_flags & f) != 0; }
   static size_t WriteData(char *, size_t, size_t, void *);
-  static int UpdateProgress(void *, double, double, double, double);
+  static size_t ReadHeader(char *, size_t, size_t, void *);
+  static int UpdateProgress(void *, curl_off_t, curl_off_t, curl_off_t, curl_off_t);
+
+  CURL *startTransfer();
+  TransferResult finishTransfer(CURLcode);
+  void collectStats();
+  void useProxy() { m_proxy = true; }
+  void readHeader(std::string_view);
+  bool checkRange();
+  Validators resumeValidators() const;
+  bool scheduleRetry(CURLcode, long status, const std::string &error);
+  void updateProgress(int64_t now, int64_t total);
 
   std::string m_url;
+  std::string m_host;
   std::string m_expectedChecksum;
   NetworkOpts m_opts;
   int m_flags;
+  int64_t m_sizeHint;
+  bool m_proxy;
+  bool m_notModified;
+  Validators m_validators;
+  Validators m_responseValidators;
+  bool m_acceptRanges;
+  bool m_encoded;
+
+  int64_t m_resumeOffset;
+  Validators m_ifRange;
+  bool m_rangeIgnored;
+
+  std::vector<std::string> m_attempts;
+  std::chrono::milliseconds m_retryDelay;
+
+  DownloadThread *m_downloadThread;
+  int64_t m_reportedReceived;
+  int64_t m_reportedExpected;
+
+  std::unique_ptr<DownloadContext> m_ctx;
+  WriteContext m_write;
+  curl_slist *m_headers;
+  std::string m_errbuf;
 };
 
 class MemoryDownload : public Download {
@@ -104,16 +245,46 @@ public:
   FileDownload(const Path &target, const std::string &url,
     const NetworkOpts &, int flags = 0);
 
+  // Removes the interrupted downloads older than maxAge seconds, then the
+  // oldest ones until the others take at most maxSize bytes.
+  static void trimPartials(time_t maxAge, int64_t maxSize);
+
   const TempPath &path() const { return m_path; }
   bool save();
 
 protected:
   std::ostream *openStream() override;
   void closeStream() override;
+  void keepPartial(const Validators &) override;
 
 private:
+  Path partialPath(const char *ext = "") const;
+  bool restorePartial();
+
   TempPath m_path;
   std::ofstream m_stream;
 };
 
+// Parses the index as it is being received instead of waiting for the
+// transfer to be over to read it back from the disk. Building the Index
+// from the document is left to a worker thread (see IndexLoader).
+class IndexDownload : public FileDownload {
+public:
+  IndexDownload(const Path &target, const std::string &url,
+    const NetworkOpts &, int flags = 0);
+  ~IndexDownload();
+
+  // null if the index was not modified
+  std::unique_ptr<XmlDocument> takeDocument();
+
+protected:
+  std::ostream *openStream() override;
+  void received(const char *, size_t) override;
+  void completed() override;
+
+private:
+  std::unique_ptr<XmlParser> m_parser;
+  std::unique_ptr<XmlDocument> m_document;
+};
+
 #endif
@@ -20,6 +20,7 @@
 
 #include <ostream>
 #include <stdexcept>
+#include <vector>
 
 #include "string.hpp"
 
@@ -31,11 +32,18 @@ public:
 struct ErrorInfo {
   std::string message;
   std::string context;
+  std::vector<std::string> attempts; // earlier failures of a retried operation
 };
 
 inline std::ostream &operator<<(std::ostream &os, const ErrorInfo &err)
 {
   os << err.context << ":\r\n" << String::indent(err.message) << "\r\n";
+
+  for(size_t i = 0; i < err.attempts.size(); ++i) {
+    os << String::indent("Attempt " + std::to_string(i + 1) + ": "
+      + err.attempts[i]) << "\r\n";
+  }
+
   return os;
 }
 
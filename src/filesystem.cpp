@@ -26,8 +26,15 @@
 #include <sys/stat.h>
 
 #ifdef _WIN32
+#  include <sys/utime.h>
 #  include <windows.h>
 #  define stat _stat
+#else
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  include <utime.h>
 #endif
 
 static auto nativePath(const Path &path)
@@ -65,12 +72,13 @@ bool FS::open(std::ifstream &stream, const Path &path)
   return stream.good();
 }
 
-bool FS::open(std::ofstream &stream, const Path &path)
+bool FS::open(std::ofstream &stream, const Path &path, const bool append)
 {
   if(!mkdir(path.dirname()))
     return false;
 
-  stream.open(nativePath(path), std::ios_base::binary);
+  stream.open(nativePath(path), append ?
+    std::ios_base::binary | std::ios_base::app : std::ios_base::binary);
   return stream.good();
 }
 
@@ -163,6 +171,29 @@ bool FS::mtime(const Path &path, time_t *time)
   return true;
 }
 
+bool FS::size(const Path &path, int64_t *size)
+{
+  struct stat st;
+
+  if(!stat(path, &st))
+    return false;
+
+  *size = st.st_size;
+
+  return true;
+}
+
+bool FS::touch(const Path &path)
+{
+#ifdef _WIN32
+  constexpr auto func = &_wutime;
+#else
+  constexpr int(*func)(const char *, const struct utimbuf *) = &::utime;
+#endif
+
+  return !func(nativePath(path).c_str(), nullptr);
+}
+
 bool FS::exists(const Path &path, const bool dir)
 {
   struct stat st;
@@ -197,6 +228,40 @@ bool FS::mkdir(const Path &path)
   return true;
 }
 
+std::vector<std::string> FS::list(const Path &dir)
+{
+  std::vector<std::string> files;
+
+#ifdef _WIN32
+  const auto &pattern = Win32::widen((dir + "*").prependRoot().join());
+
+  WIN32_FIND_DATA fd{};
+  HANDLE handle = FindFirstFile(pattern.c_str(), &fd);
+  if(handle == INVALID_HANDLE_VALUE)
+    return files;
+
+  do {
+    if(!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      files.push_back(Win32::narrow(fd.cFileName));
+  } while(FindNextFile(handle, &fd));
+
+  FindClose(handle);
+#else
+  DIR *handle = opendir(nativePath(dir).c_str());
+  if(!handle)
+    return files;
+
+  while(const dirent *entry = readdir(handle)) {
+    if(!exists(dir + entry->d_name, true))
+      files.push_back(entry->d_name);
+  }
+
+  closedir(handle);
+#endif
+
+  return files;
+}
+
 Path FS::canonical(const Path &path)
 {
 #ifdef _WIN32
@@ -215,3 +280,59 @@ const char *FS::lastError()
 {
   return strerror(errno);
 }
+
+FS::MappedFile::MappedFile(const Path &path)
+  : m_data(nullptr), m_size(0)
+{
+  const auto &fullPath = nativePath(path);
+
+#ifdef _WIN32
+  HANDLE file = CreateFile(fullPath.c_str(), GENERIC_READ,
+    FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER size;
+  if(GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+    if(HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+      m_data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      if(m_data)
+        m_size = static_cast<size_t>(size.QuadPart);
+
+      // the view keeps a reference to the mapping
+      CloseHandle(mapping);
+    }
+  }
+
+  CloseHandle(file);
+#else
+  const int fd = ::open(fullPath.c_str(), O_RDONLY);
+  if(fd < 0)
+    return;
+
+  struct stat st;
+  if(!fstat(fd, &st) && st.st_size > 0) {
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data != MAP_FAILED) {
+      m_data = static_cast<const char *>(data);
+      m_size = st.st_size;
+    }
+  }
+
+  close(fd);
+#endif
+}
+
+FS::MappedFile::~MappedFile()
+{
+  if(!m_data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<char *>(m_data), m_size);
+#endif
+}
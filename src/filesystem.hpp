@@ -19,7 +19,9 @@
 #define REAPACK_FILESYSTEM_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class Path;
 class TempPath;
@@ -27,15 +29,18 @@ class TempPath;
 namespace FS {
   FILE *open(const Path &);
   bool open(std::ifstream &, const Path &);
-  bool open(std::ofstream &, const Path &);
+  bool open(std::ofstream &, const Path &, bool append = false);
   bool write(const Path &, const std::string &);
   bool rename(const TempPath &);
   bool rename(const Path &, const Path &);
   bool remove(const Path &);
   bool removeRecursive(const Path &);
   bool mtime(const Path &, time_t *);
+  bool size(const Path &, int64_t *);
+  bool touch(const Path &);
   bool exists(const Path &, bool dir = false);
   bool mkdir(const Path &);
+  std::vector<std::string> list(const Path &dir); // file names
   Path canonical(const Path &);
 
   const char *lastError();
@@ -47,6 +52,22 @@ namespace FS {
     return std::all_of(container.begin(), container.end(),
       [&dir](const Path &path) { return exists(path, dir); });
   }
+
+  // read-only view of a whole file mapped into memory
+  class MappedFile {
+  public:
+    MappedFile(const Path &);
+    MappedFile(const MappedFile &) = delete;
+    ~MappedFile();
+
+    operator bool() const { return m_data != nullptr; }
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+  private:
+    const char *m_data;
+    size_t m_size;
+  };
 };
 
 #endif
@@ -222,6 +222,8 @@ bool Import::import(const ImportData &data)
   g_reapack->addSetRemote(data.remote);
 
   FS::write(Index::pathFor(data.remote.name()), data.contents);
+  FS::remove(Index::validatorsPathFor(data.remote.name()));
+  FS::remove(Index::snapshotPathFor(data.remote.name()));
 
   return true;
 }
@@ -25,26 +25,109 @@
 
 #include <cstring>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+// Indexes still in use somewhere (transactions, dialogs, API calls...) are
+// shared instead of being loaded again as long as their file is unchanged.
+struct CachedIndex {
+  std::weak_ptr<const Index> index;
+  time_t mtime;
+  int64_t size;
+};
+
+static std::mutex s_cacheMutex;
+static std::unordered_map<std::string, CachedIndex> s_cache;
 
 Path Index::pathFor(const std::string &name)
 {
   return Path::CACHE + (name + ".xml");
 }
 
+Path Index::validatorsPathFor(const std::string &name)
+{
+  return Path::CACHE + (name + ".http");
+}
+
+Path Index::snapshotPathFor(const std::string &name)
+{
+  return Path::CACHE + (name + ".snapshot");
+}
+
 IndexPtr Index::load(const std::string &name, const char *data)
 {
-  std::unique_ptr<std::istream> stream;
+  if(data) {
+    std::istringstream stream(data);
+    return load(name, XmlDocument(stream));
+  }
+
+  const Path &path = pathFor(name);
+
+  // the snapshot is only valid for the exact copy of the index it was made from
+  time_t mtime = 0;
+  int64_t size = 0;
+  const bool stamped = FS::mtime(path, &mtime) && FS::size(path, &size);
+
+  if(stamped) {
+    if(IndexPtr ri = findCached(name, mtime, size))
+      return ri;
+    else if((ri = loadSnapshot(name, mtime, size))) {
+      cache(ri, mtime, size);
+      return ri;
+    }
+  }
+
+  std::ifstream stream;
+  if(!FS::open(stream, path))
+    throw reapack_error(FS::lastError());
+
+  const IndexPtr &ri = load(name, XmlDocument(stream));
+
+  if(stamped) {
+    ri->saveSnapshot(mtime, size);
+    cache(ri, mtime, size);
+  }
+
+  return ri;
+}
+
+IndexPtr Index::findCached(const std::string &name,
+  const time_t mtime, const int64_t size)
+{
+  std::lock_guard<std::mutex> guard(s_cacheMutex);
+
+  const auto &it = s_cache.find(name);
+  if(it == s_cache.end())
+    return nullptr;
 
-  if(data)
-    stream = std::make_unique<std::istringstream>(data);
-  else {
-    stream = std::make_unique<std::ifstream>();
-    if(!FS::open(*dynamic_cast<std::ifstream *>(stream.get()), pathFor(name)))
-      throw reapack_error(FS::lastError());
+  const CachedIndex &entry = it->second;
+  if(entry.mtime == mtime && entry.size == size) {
+    if(IndexPtr ri = entry.index.lock())
+      return ri;
   }
 
-  XmlDocument doc(*stream);
+  s_cache.erase(it);
+  return nullptr;
+}
+
+void Index::cache(const IndexPtr &ri, const time_t mtime, const int64_t size)
+{
+  std::lock_guard<std::mutex> guard(s_cacheMutex);
+
+  // forget the indexes nobody uses anymore
+  for(auto it = s_cache.begin(); it != s_cache.end();) {
+    if(it->second.index.expired())
+      it = s_cache.erase(it);
+    else
+      ++it;
+  }
 
+  s_cache[ri->name()] = {ri, mtime, size};
+}
+
+IndexPtr Index::load(const std::string &name, const XmlDocument &doc)
+{
   if(!doc)
     throw reapack_error(doc.error());
 
@@ -147,7 +230,7 @@ Category::~Category()
 
 std::string Category::fullName() const
 {
-  return m_index ? m_index->name() + "/" + m_name : m_name;
+  return m_index ? m_index->name() + "/" + m_name.str() : m_name.str();
 }
 
 bool Category::addPackage(const Package *pkg)
@@ -22,6 +22,7 @@
 #include "package.hpp"
 #include "source.hpp"
 
+#include <ctime>
 #include <map>
 #include <memory>
 #include <string>
@@ -31,6 +32,7 @@
 class Index;
 class Path;
 class Remote;
+class XmlDocument;
 class XmlNode;
 struct NetworkOpts;
 
@@ -39,7 +41,10 @@ typedef std::shared_ptr<const Index> IndexPtr;
 class Index : public std::enable_shared_from_this<const Index> {
 public:
   static Path pathFor(const std::string &name);
+  static Path validatorsPathFor(const std::string &name);
+  static Path snapshotPathFor(const std::string &name);
   static IndexPtr load(const std::string &name, const char *data = nullptr);
+  static IndexPtr load(const std::string &name, const XmlDocument &);
 
   Index(const std::string &name);
   ~Index();
@@ -58,10 +63,19 @@ public:
 
   const std::vector<const Package *> &packages() const { return m_packages; }
 
+  // writes a binary copy of the index for faster loading next time and
+  // shares this instance with the next callers of load(name)
+  bool saveSnapshot() const;
+
 private:
   static void loadV1(XmlNode, Index *);
+  static IndexPtr loadSnapshot(const std::string &name, time_t mtime, int64_t size);
+  static IndexPtr findCached(const std::string &name, time_t mtime, int64_t size);
+  static void cache(const IndexPtr &, time_t mtime, int64_t size);
+  bool saveSnapshot(time_t mtime, int64_t size) const;
 
   std::string m_name;
+  std::unique_ptr<LazyText::File> m_snapshot; // changelogs and descriptions
   Metadata m_metadata;
   std::vector<const Category *> m_categories;
   std::vector<const Package *> m_packages;
@@ -86,7 +100,7 @@ public:
 private:
   const Index *m_index;
 
-  std::string m_name;
+  InternedString m_name;
   std::vector<const Package *> m_packages;
   std::unordered_map<std::string, size_t> m_pkgMap;
 };
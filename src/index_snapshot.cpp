@@ -0,0 +1,315 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "index.hpp"
+
+#include "errors.hpp"
+#include "filesystem.hpp"
+#include "path.hpp"
+#include "platform.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+// Binary copy of a parsed index, stored next to its XML file. It is read
+// straight from a memory-mapped file and is only used when the modification
+// time and size of the XML file match the ones it was made from. Long texts
+// (changelogs and descriptions) are left in the file until they are displayed.
+
+static const char SNAPSHOT_MAGIC[8] = {'R', 'P', 'K', 'S', 'N', 'A', 'P', '\0'};
+// increment when changing the layout below
+static const uint32_t SNAPSHOT_FORMAT = 1;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t format;
+  uint32_t platform; // the sources of other platforms were discarded
+  int64_t mtime;
+  int64_t size;
+};
+
+class SnapshotWriter {
+public:
+  template<typename T>
+  void write(const T value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    m_buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void write(const std::string &str)
+  {
+    write(static_cast<uint32_t>(str.size()));
+    m_buffer.append(str);
+  }
+
+  void write(const Metadata *);
+
+  const std::string &buffer() const { return m_buffer; }
+
+private:
+  std::string m_buffer;
+};
+
+class SnapshotReader {
+public:
+  SnapshotReader(const char *data, const size_t size)
+    : m_begin(data), m_pos(data), m_end(data + size), m_texts(nullptr) {}
+
+  void setTextFile(const LazyText::File *file) { m_texts = file; }
+
+  template<typename T>
+  T read()
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string readString()
+  {
+    const uint32_t size = read<uint32_t>();
+    return {take(size), size};
+  }
+
+  LazyText readText()
+  {
+    const uint32_t size = read<uint32_t>();
+    const char *data = take(size);
+
+    // short strings fit in std::string without an allocation
+    if(size <= 15 || !m_texts)
+      return std::string(data, size);
+
+    return {m_texts, static_cast<uint32_t>(data - m_begin), size};
+  }
+
+  void read(Metadata *);
+
+private:
+  const char *take(const size_t size)
+  {
+    if(static_cast<size_t>(m_end - m_pos) < size)
+      throw reapack_error("truncated index snapshot");
+
+    const char *data = m_pos;
+    m_pos += size;
+    return data;
+  }
+
+  const char *m_begin;
+  const char *m_pos;
+  const char *m_end;
+  const LazyText::File *m_texts;
+};
+
+void SnapshotWriter::write(const Metadata *md)
+{
+  write(md->about());
+  write(static_cast<uint32_t>(md->links().size()));
+
+  for(const auto &[type, link] : md->links()) {
+    write(static_cast<uint8_t>(type));
+    write(link.name);
+    write(link.url);
+  }
+}
+
+void SnapshotReader::read(Metadata *md)
+{
+  md->setAbout(readText());
+
+  for(uint32_t links = read<uint32_t>(); links > 0; --links) {
+    const auto type = static_cast<Metadata::LinkType>(read<uint8_t>());
+    std::string name = readString(), url = readString();
+    md->addLink(type, {name, url});
+  }
+}
+
+static void LoadSourceSnapshot(SnapshotReader &reader, Version *ver)
+{
+  const std::string &file = reader.readString(), &url = reader.readString();
+
+  Source *src = new Source(file, url, ver);
+  std::unique_ptr<Source> ptr(src);
+
+  src->setChecksum(reader.readString());
+  src->setSize(reader.read<int64_t>());
+  src->setPlatform(static_cast<Platform::Enum>(reader.read<uint32_t>()));
+  src->setTypeOverride(static_cast<Package::Type>(reader.read<uint8_t>()));
+  src->setSections(reader.read<int32_t>());
+
+  if(ver->addSource(src))
+    ptr.release();
+}
+
+static void LoadVersionSnapshot(SnapshotReader &reader, Package *pkg)
+{
+  Version *ver = new Version(reader.readString(), pkg);
+  std::unique_ptr<Version> ptr(ver);
+
+  ver->setAuthor(reader.readString());
+
+  int time[6];
+  for(int &field : time)
+    field = reader.read<int32_t>();
+  ver->setTime({time[0], time[1], time[2], time[3], time[4], time[5]});
+
+  ver->setChangelog(reader.readText());
+
+  for(uint32_t sources = reader.read<uint32_t>(); sources > 0; --sources)
+    LoadSourceSnapshot(reader, ver);
+
+  if(pkg->addVersion(ver))
+    ptr.release();
+}
+
+static void LoadPackageSnapshot(SnapshotReader &reader, Category *cat)
+{
+  const auto type = static_cast<Package::Type>(reader.read<uint8_t>());
+
+  Package *pkg = new Package(type, reader.readString(), cat);
+  std::unique_ptr<Package> ptr(pkg);
+
+  pkg->setDescription(reader.readString());
+  reader.read(pkg->metadata());
+
+  for(uint32_t versions = reader.read<uint32_t>(); versions > 0; --versions)
+    LoadVersionSnapshot(reader, pkg);
+
+  if(cat->addPackage(pkg))
+    ptr.release();
+}
+
+static void LoadCategorySnapshot(SnapshotReader &reader, Index *ri)
+{
+  Category *cat = new Category(reader.readString(), ri);
+  std::unique_ptr<Category> ptr(cat);
+
+  for(uint32_t packages = reader.read<uint32_t>(); packages > 0; --packages)
+    LoadPackageSnapshot(reader, cat);
+
+  if(ri->addCategory(cat))
+    ptr.release();
+}
+
+IndexPtr Index::loadSnapshot(const std::string &name,
+  const time_t mtime, const int64_t size)
+{
+  // kept mapped for the lifetime of the index, which reads its long texts
+  // from it when they are first requested
+  auto texts = std::make_unique<LazyText::File>(snapshotPathFor(name));
+  const FS::MappedFile &file = texts->data();
+  if(!file)
+    return nullptr;
+
+  SnapshotReader reader(file.data(), file.size());
+  reader.setTextFile(texts.get());
+
+  try {
+    const auto &header = reader.read<SnapshotHeader>();
+    if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) ||
+        header.format != SNAPSHOT_FORMAT || header.platform != Platform::Current ||
+        header.mtime != mtime || header.size != size)
+      return nullptr;
+
+    auto ri = std::make_shared<Index>(name);
+    ri->m_snapshot = std::move(texts);
+    reader.read(ri->metadata());
+
+    for(uint32_t categories = reader.read<uint32_t>(); categories > 0; --categories)
+      LoadCategorySnapshot(reader, ri.get());
+
+    return ri;
+  }
+  catch(const reapack_error &) {
+    // fallback to the XML file
+    return nullptr;
+  }
+}
+
+bool Index::saveSnapshot() const
+{
+  const Path &path = pathFor(m_name);
+
+  time_t mtime;
+  int64_t size;
+  if(!FS::mtime(path, &mtime) || !FS::size(path, &size))
+    return false;
+
+  cache(shared_from_this(), mtime, size);
+
+  return saveSnapshot(mtime, size);
+}
+
+bool Index::saveSnapshot(const time_t mtime, const int64_t size) const
+{
+  SnapshotHeader header{};
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.format = SNAPSHOT_FORMAT;
+  header.platform = Platform::Current;
+  header.mtime = mtime;
+  header.size = size;
+
+  SnapshotWriter writer;
+  writer.write(header);
+  writer.write(&m_metadata);
+  writer.write(static_cast<uint32_t>(m_categories.size()));
+
+  for(const Category *cat : m_categories) {
+    writer.write(cat->name());
+    writer.write(static_cast<uint32_t>(cat->packages().size()));
+
+    for(const Package *pkg : cat->packages()) {
+      writer.write(static_cast<uint8_t>(pkg->type()));
+      writer.write(pkg->name());
+      writer.write(pkg->description());
+      writer.write(pkg->metadata());
+      writer.write(static_cast<uint32_t>(pkg->versions().size()));
+
+      for(const Version *ver : pkg->versions()) {
+        writer.write(ver->name().toString());
+        writer.write(ver->author());
+
+        const Time &time = ver->time();
+        for(const int field : {time.year(), time.month(), time.day(),
+            time.hour(), time.minute(), time.second()})
+          writer.write(static_cast<int32_t>(field));
+
+        writer.write(ver->changelog());
+        writer.write(static_cast<uint32_t>(ver->sources().size()));
+
+        for(const Source *src : ver->sources()) {
+          writer.write(src->file());
+          writer.write(src->url());
+          writer.write(src->checksum());
+          writer.write(static_cast<int64_t>(src->size()));
+          writer.write(static_cast<uint32_t>(src->platform().value()));
+          writer.write(static_cast<uint8_t>(src->typeOverride()));
+          writer.write(static_cast<int32_t>(src->sections()));
+        }
+      }
+    }
+  }
+
+  // write to a temporary file first so a concurrent reader never maps
+  // a partially written snapshot
+  const TempPath path(snapshotPathFor(m_name));
+  return FS::write(path.temp(), writer.buffer()) && FS::rename(path);
+}
@@ -20,6 +20,8 @@
 #include "errors.hpp"
 #include "xml.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 
 static void LoadMetadataV1(XmlNode, Metadata *);
@@ -152,6 +154,7 @@ void LoadSourceV1(XmlNode node, Version *ver, const bool hasArm64Ec)
                   &type     = node.attribute("type"),
                   &file     = node.attribute("file"),
                   &checksum = node.attribute("hash"),
+                  &size     = node.attribute("size"),
                   &main     = node.attribute("main"),
                   &url      = node.text();
 
@@ -159,6 +162,7 @@ void LoadSourceV1(XmlNode node, Version *ver, const bool hasArm64Ec)
   std::unique_ptr<Source> ptr(src);
 
   src->setChecksum(checksum.value_or(""));
+  src->setSize(std::max<int64_t>(0, std::strtoll(size.value_or("0"), nullptr, 10)));
   src->setPlatform(Platform(platform.value_or("all"), hasArm64Ec));
   src->setTypeOverride(Package::getType(type.value_or("")));
 
@@ -18,11 +18,12 @@
 #include "task.hpp"
 
 #include "archive.hpp"
+#include "broker.hpp"
 #include "config.hpp"
-#include "download.hpp"
 #include "filesystem.hpp"
 #include "index.hpp"
 #include "reapack.hpp"
+#include "store.hpp"
 #include "transaction.hpp"
 
 InstallTask::InstallTask(const Version *ver, const int flags,
@@ -69,18 +70,81 @@ bool InstallTask::start()
       FileExtractor *ex = new FileExtractor(targetPath, m_reader);
       push(ex, ex->path());
     }
-    else {
-      const NetworkOpts &opts = g_reapack->config()->network;
-      FileDownload *dl = new FileDownload(targetPath, src->url(), opts);
-      dl->setExpectedChecksum(src->checksum());
-      push(dl, dl->path());
-    }
+    else if(const Path &stored = find(src); !stored.empty())
+      copy(src, stored);
+    else
+      download(src);
   }
 
   return true;
 }
 
+void InstallTask::copy(const Source *src, const Path &stored)
+{
+  FileCopy *job = new FileCopy(stored, src->targetPath(), src->checksum());
+
+  job->onStartAsync >> [=] { m_newFiles.push_back(job->path()); };
+  job->onFinishAsync >> [=] {
+    m_waiting.erase(job);
+
+    if(job->state() == ThreadTask::Success)
+      return;
+    else if(!job->corruptSource() || m_fail) {
+      rollback();
+      return;
+    }
+
+    // evict the damaged object and get a fresh copy from the network instead
+    tx()->store()->remove(src->checksum());
+    FS::remove(job->path().temp());
+
+    const auto &it = find_if(m_newFiles.begin(), m_newFiles.end(),
+      [&](const TempPath &p) { return p.target() == job->path().target(); });
+    if(it != m_newFiles.end())
+      m_newFiles.erase(it);
+
+    download(src);
+  };
+
+  m_waiting.insert(job);
+  tx()->threadPool()->push(job);
+}
+
+void InstallTask::download(const Source *src)
+{
+  const Path &targetPath = src->targetPath();
+  const int64_t sizeHint = src->size() ? src->size()
+    : tx()->store()->sizeHint(targetPath);
+  SharedFile *file = tx()->downloads()->fetch(src->url(), src->checksum(),
+    targetPath, sizeHint);
+  store(file);
+  watch(file, file->path());
+}
+
+Path InstallTask::find(const Source *src) const
+{
+  if(!g_reapack->config()->install.storeSize)
+    return {};
+
+  return tx()->store()->find(src->checksum());
+}
+
+void InstallTask::store(SharedFile *file)
+{
+  file->onFinishAsync >> [=] {
+    // for scheduling the next download of this file
+    if(file->state() == ThreadTask::Success)
+      tx()->store()->setSizeHint(file->path().target(), file->size());
+  };
+}
+
 void InstallTask::push(ThreadTask *job, const TempPath &path)
+{
+  watch(job, path);
+  tx()->threadPool()->push(job);
+}
+
+void InstallTask::watch(ThreadTask *job, const TempPath &path)
 {
   job->onStartAsync >> [=] { m_newFiles.push_back(path); };
   job->onFinishAsync >> [=] {
@@ -91,7 +155,6 @@ void InstallTask::push(ThreadTask *job, const TempPath &path)
   };
 
   m_waiting.insert(job);
-  tx()->threadPool()->push(job);
 }
 
 void InstallTask::commit()
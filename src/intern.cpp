@@ -0,0 +1,138 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "intern.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+// std::string keeps up to 15 characters inline with the common standard
+// libraries, only longer copies cost a heap allocation
+static constexpr size_t SSO_CAPACITY = 15;
+
+struct Pool {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::atomic<size_t>> entries;
+  InternedString::Stats stats{};
+};
+
+static Pool &pool()
+{
+  // never destroyed: handles may outlive static destruction order
+  static auto *pool = new Pool;
+  return *pool;
+}
+
+static InternedString::Entry *emptyEntry()
+{
+  // permanently referenced, so it is never released
+  static InternedString::Entry entry(std::piecewise_construct,
+    std::forward_as_tuple(), std::forward_as_tuple(1));
+  return &entry;
+}
+
+static InternedString::Entry *intern(const std::string &str)
+{
+  Pool &pool = ::pool();
+  std::lock_guard<std::mutex> guard(pool.mutex);
+
+  const auto &[it, inserted] = pool.entries.try_emplace(str, 0);
+
+  if(inserted) {
+    ++pool.stats.strings;
+    pool.stats.bytes += str.size();
+  }
+  else {
+    ++pool.stats.references;
+    if(str.size() > SSO_CAPACITY)
+      pool.stats.savedBytes += str.size() + 1;
+  }
+
+  // handles are only created from an existing one or under the lock,
+  // so the count cannot reach zero concurrently
+  ++it->second;
+
+  return &*it;
+}
+
+auto InternedString::stats() -> Stats
+{
+  Pool &pool = ::pool();
+  std::lock_guard<std::mutex> guard(pool.mutex);
+  return pool.stats;
+}
+
+InternedString::InternedString()
+  : m_entry(emptyEntry())
+{
+  ++m_entry->second;
+}
+
+InternedString::InternedString(const std::string &str)
+  : m_entry(str.empty() ? emptyEntry() : intern(str))
+{
+  if(str.empty())
+    ++m_entry->second;
+}
+
+InternedString::InternedString(const char *str)
+  : InternedString(std::string(str))
+{
+}
+
+InternedString::InternedString(const InternedString &o)
+  : m_entry(o.m_entry)
+{
+  m_entry->second.fetch_add(1, std::memory_order_relaxed);
+}
+
+InternedString::~InternedString()
+{
+  release();
+}
+
+InternedString &InternedString::operator=(const InternedString &o)
+{
+  if(m_entry != o.m_entry) {
+    o.m_entry->second.fetch_add(1, std::memory_order_relaxed);
+    release();
+    m_entry = o.m_entry;
+  }
+
+  return *this;
+}
+
+void InternedString::release()
+{
+  // drop a reference without locking as long as it isn't the last one
+  size_t refs = m_entry->second.load(std::memory_order_relaxed);
+  while(refs > 1) {
+    if(m_entry->second.compare_exchange_weak(refs, refs - 1,
+        std::memory_order_release, std::memory_order_relaxed))
+      return;
+  }
+
+  Pool &pool = ::pool();
+  std::lock_guard<std::mutex> guard(pool.mutex);
+
+  if(--m_entry->second > 0)
+    return;
+
+  pool.stats.strings -= 1;
+  pool.stats.bytes -= m_entry->first.size();
+  pool.entries.erase(pool.entries.find(m_entry->first));
+}
@@ -0,0 +1,78 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_INTERN_HPP
+#define REAPACK_INTERN_HPP
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <utility>
+
+// Handle to an immutable string stored once in a process-wide pool.
+// Equal strings share the same storage, so copying or comparing handles
+// never touches the characters. Pooled strings are reference counted and
+// leave the pool along with their last handle.
+class InternedString {
+public:
+  struct Stats {
+    size_t strings;    // distinct strings in the pool
+    size_t bytes;      // characters stored in the pool
+    size_t references; // handles created for an already pooled string
+    size_t savedBytes; // heap bytes those handles would have copied
+  };
+
+  static Stats stats();
+
+  InternedString();
+  InternedString(const std::string &);
+  InternedString(const char *);
+  InternedString(const InternedString &);
+  ~InternedString();
+
+  InternedString &operator=(const InternedString &);
+
+  const std::string &str() const { return m_entry->first; }
+  operator const std::string &() const { return str(); }
+  const char *c_str() const { return str().c_str(); }
+  size_t size() const { return str().size(); }
+  bool empty() const { return str().empty(); }
+
+  bool operator==(const InternedString &o) const { return m_entry == o.m_entry; }
+  bool operator!=(const InternedString &o) const { return m_entry != o.m_entry; }
+  bool operator<(const InternedString &o) const { return str() < o.str(); }
+
+  // string and number of handles referring to it
+  typedef std::pair<const std::string, std::atomic<size_t>> Entry;
+
+private:
+  void release();
+
+  Entry *m_entry;
+};
+
+inline bool operator==(const InternedString &l, const std::string &r) { return l.str() == r; }
+inline bool operator!=(const InternedString &l, const std::string &r) { return l.str() != r; }
+inline bool operator==(const InternedString &l, const char *r) { return l.str() == r; }
+inline bool operator!=(const InternedString &l, const char *r) { return l.str() != r; }
+
+inline std::ostream &operator<<(std::ostream &os, const InternedString &s)
+{
+  return os << s.str();
+}
+
+#endif
@@ -0,0 +1,44 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lazytext.hpp"
+
+LazyText::File::File(const Path &path)
+  : m_data(path)
+{
+}
+
+LazyText::LazyText(const File *file, const uint32_t offset, const uint32_t size)
+  : m_file(file), m_offset(offset), m_size(size), m_loaded(false)
+{
+}
+
+const std::string &LazyText::get() const
+{
+  if(!m_file)
+    return m_text;
+
+  // the text is never modified after being copied out of the file
+  std::lock_guard<std::mutex> guard(m_file->mutex());
+
+  if(!m_loaded) {
+    m_text.assign(m_file->data().data() + m_offset, m_size);
+    m_loaded = true;
+  }
+
+  return m_text;
+}
@@ -0,0 +1,58 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_LAZYTEXT_HPP
+#define REAPACK_LAZYTEXT_HPP
+
+#include "filesystem.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Text kept either in memory or in a file it is copied from when first used.
+class LazyText {
+public:
+  // File holding the texts. It stays mapped into memory for as long as this
+  // object exists, so the texts remain valid even if the file is replaced.
+  class File {
+  public:
+    File(const Path &);
+
+    const FS::MappedFile &data() const { return m_data; }
+    std::mutex &mutex() const { return m_mutex; }
+
+  private:
+    FS::MappedFile m_data;
+    mutable std::mutex m_mutex;
+  };
+
+  LazyText() : m_file(nullptr) {}
+  LazyText(const std::string &text) : m_text(text), m_file(nullptr) {}
+  LazyText(const File *, uint32_t offset, uint32_t size);
+
+  const std::string &get() const;
+
+private:
+  mutable std::string m_text;
+  const File *m_file;
+  uint32_t m_offset;
+  uint32_t m_size;
+  mutable bool m_loaded;
+};
+
+#endif
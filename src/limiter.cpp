@@ -0,0 +1,129 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "limiter.hpp"
+
+#include "config.hpp"
+
+#include <algorithm>
+
+// maximum amount of simultaneous transfers unless configured otherwise
+static const unsigned int DEFAULT_TOTAL = 32;
+static const unsigned int INITIAL_WINDOW = 6;
+// weight of the latest transfer in the average speed of a host
+static const double SPEED_SMOOTHING = 0.25;
+
+ConnectionLimiter::ConnectionLimiter()
+  : m_total(DEFAULT_TOTAL), m_active(0)
+{
+}
+
+void ConnectionLimiter::configure(const NetworkOpts &opts)
+{
+  if(opts.maxConnections)
+    setTotal(opts.maxConnections);
+
+  for(const auto &[host, limit] : opts.hostConnections)
+    setHostLimit(host, limit);
+}
+
+void ConnectionLimiter::setHostLimit(const std::string &name, const unsigned int limit)
+{
+  m_limits[name] = std::max(limit, 1u);
+
+  const auto it = m_hosts.find(name);
+  if(it != m_hosts.end())
+    it->second.window = std::min(it->second.window, m_limits[name]);
+}
+
+unsigned int ConnectionLimiter::limit(const std::string &name) const
+{
+  const auto it = m_limits.find(name);
+  return std::min(it == m_limits.end() ? m_total : it->second, m_total);
+}
+
+auto ConnectionLimiter::host(const std::string &name) -> Host &
+{
+  const auto it = m_hosts.find(name);
+  if(it != m_hosts.end())
+    return it->second;
+
+  const Host host { 0, std::min(INITIAL_WINDOW, limit(name)), 0, 0 };
+  return m_hosts.emplace(name, host).first->second;
+}
+
+unsigned int ConnectionLimiter::window(const std::string &name) const
+{
+  const auto it = m_hosts.find(name);
+  if(it != m_hosts.end())
+    return it->second.window;
+
+  return std::min(INITIAL_WINDOW, limit(name));
+}
+
+bool ConnectionLimiter::available(const std::string &name) const
+{
+  if(m_active >= m_total)
+    return false;
+
+  const auto it = m_hosts.find(name);
+  return it == m_hosts.end() || it->second.active < it->second.window;
+}
+
+void ConnectionLimiter::acquire(const std::string &name)
+{
+  ++host(name).active;
+  ++m_active;
+}
+
+void ConnectionLimiter::release(const std::string &name)
+{
+  Host &h = host(name);
+
+  if(h.active > 0) {
+    --h.active;
+    --m_active;
+  }
+}
+
+void ConnectionLimiter::succeeded(const std::string &name, const double speed)
+{
+  release(name);
+
+  Host &h = host(name);
+
+  // a transfer much slower than usual means the connections already open
+  // are competing for the bandwidth: opening more wouldn't help
+  const bool slow = h.speed > 0 && speed < h.speed / 2;
+  h.speed = h.speed > 0 ? h.speed + (speed - h.speed) * SPEED_SMOOTHING : speed;
+
+  if(slow)
+    h.successes = 0;
+  else if(++h.successes >= h.window) {
+    h.window = std::min(h.window + 1, limit(name));
+    h.successes = 0;
+  }
+}
+
+void ConnectionLimiter::congested(const std::string &name)
+{
+  release(name);
+
+  Host &h = host(name);
+  h.window = std::max(h.window / 2, 1u);
+  h.successes = 0;
+}
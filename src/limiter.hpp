@@ -0,0 +1,66 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_LIMITER_HPP
+#define REAPACK_LIMITER_HPP
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+struct NetworkOpts;
+
+// Shares the transfer slots of a DownloadThread between hosts.
+// Each host starts with a small window of simultaneous connections growing by
+// one after a full window of successful transfers, and halved whenever the
+// host shows signs of congestion (AIMD).
+class ConnectionLimiter {
+public:
+  ConnectionLimiter();
+
+  void configure(const NetworkOpts &);
+  void setTotal(unsigned int total) { m_total = std::max(total, 1u); }
+  void setHostLimit(const std::string &host, unsigned int limit);
+
+  bool available(const std::string &host) const;
+  void acquire(const std::string &host);
+  void release(const std::string &host);
+  void succeeded(const std::string &host, double bytesPerSecond);
+  void congested(const std::string &host);
+
+  unsigned int active() const { return m_active; }
+  unsigned int window(const std::string &host) const;
+
+private:
+  struct Host {
+    unsigned int active;
+    unsigned int window;
+    unsigned int successes; // since the last window change
+    double speed;           // moving average, bytes per second
+  };
+
+  Host &host(const std::string &);
+  unsigned int limit(const std::string &) const;
+
+  unsigned int m_total;
+  unsigned int m_active;
+  std::map<std::string, unsigned int> m_limits;
+  std::unordered_map<std::string, Host> m_hosts;
+};
+
+#endif
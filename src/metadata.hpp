@@ -18,6 +18,8 @@
 #ifndef REAPACK_METADATA_HPP
 #define REAPACK_METADATA_HPP
 
+#include "lazytext.hpp"
+
 #include <map>
 #include <string>
 #include <vector>
@@ -35,12 +37,13 @@ public:
   static LinkType getLinkType(const char *rel);
 
   void setAbout(const std::string &rtf) { m_about = rtf; }
-  const std::string &about() const { return m_about; }
+  void setAbout(const LazyText &rtf) { m_about = rtf; }
+  const std::string &about() const { return m_about.get(); }
   void addLink(const LinkType, const Link &);
   const auto &links() const { return m_links; }
 
 private:
-  std::string m_about;
+  LazyText m_about;
   std::multimap<LinkType, Link> m_links;
 };
 
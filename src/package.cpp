@@ -21,7 +21,7 @@
 #include "index.hpp"
 
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
+#include <cstring>
 
 Package::Type Package::getType(const char *type)
 {
@@ -88,7 +88,7 @@ const std::string &Package::displayName(const std::string &name, const std::stri
 }
 
 Package::Package(const Type type, const std::string &name, const Category *cat)
-  : m_category(cat), m_type(type), m_name(name)
+  : m_category(cat), m_type(type), m_name(name), m_lastStable(nullptr)
 {
   if(m_name.empty())
     throw reapack_error("empty package name");
@@ -115,22 +115,27 @@ bool Package::addVersion(const Version *ver)
     throw reapack_error("version belongs to another package");
   else if(ver->sources().empty())
     return false;
-  else if(m_versions.count(ver)) {
+
+  const auto &it = upper_bound(m_versions.begin(), m_versions.end(), ver,
+    [] (const Version *l, const Version *r) { return l->name() < r->name(); });
+
+  if(it != m_versions.begin() && (*std::prev(it))->name() == ver->name()) {
     throw reapack_error(String::format("duplicate version '%s'",
       ver->fullName().c_str()));
   }
 
-  m_versions.insert(ver);
+  m_versions.insert(it, ver);
+
+  if(ver->name().isStable() &&
+      (!m_lastStable || m_lastStable->name() < ver->name()))
+    m_lastStable = ver;
 
   return true;
 }
 
 const Version *Package::version(const size_t index) const
 {
-  auto it = m_versions.begin();
-  advance(it, index);
-
-  return *it;
+  return m_versions[index];
 }
 
 const Version *Package::lastVersion(const bool pres, const VersionName &from) const
@@ -138,22 +143,20 @@ const Version *Package::lastVersion(const bool pres, const VersionName &from) co
   if(m_versions.empty())
     return nullptr;
 
-  for(const Version *ver : m_versions | boost::adaptors::reversed) {
-    if(ver->name() < from)
-      break;
-    else if(ver->name().isStable() || pres)
-      return ver;
-  }
+  const Version *latest = pres ? m_versions.back() : m_lastStable;
+  if(latest && latest->name() >= from)
+    return latest;
 
-  return from.isStable() ? nullptr : *m_versions.rbegin();
+  // nothing newer than 'from', stay on the prerelease channel if already in it
+  return from.isStable() ? nullptr : m_versions.back();
 }
 
 const Version *Package::findVersion(const VersionName &ver) const
 {
-  const auto &it = find_if(m_versions.begin(), m_versions.end(),
-    [=] (const Version *cur) { return cur->name() == ver; });
+  const auto &it = lower_bound(m_versions.begin(), m_versions.end(), ver,
+    [] (const Version *cur, const VersionName &name) { return cur->name() < name; });
 
-  if(it == m_versions.end())
+  if(it == m_versions.end() || (*it)->name() != ver)
     return nullptr;
   else
     return *it;
@@ -37,6 +37,8 @@ const Path Path::DATA("ReaPack");
 const Path Path::CACHE = Path::DATA + "cache";
 const Path Path::CONFIG("reapack.ini");
 const Path Path::REGISTRY = Path::DATA + "registry.db";
+const Path Path::STORE = Path::DATA + "store";
+const Path Path::TELEMETRY = Path::DATA + "network.jsonl";
 
 Path Path::s_root;
 
@@ -35,6 +35,8 @@ public:
   static const Path CACHE;
   static const Path CONFIG;
   static const Path REGISTRY;
+  static const Path STORE;
+  static const Path TELEMETRY;
 
   static const Path &root() { return s_root; }
 
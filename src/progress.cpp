@@ -22,12 +22,18 @@
 
 #include <sstream>
 
+// weight of the latest measure in the displayed transfer speed
+static const double SPEED_SMOOTHING = 0.2;
+
 Progress::Progress(ThreadPool *pool)
   : Dialog(IDD_PROGRESS_DIALOG),
     m_pool(pool), m_current(), m_label(nullptr), m_progress(nullptr),
-    m_done(0), m_total(0)
+    m_transfer(nullptr), m_done(0), m_total(0), m_received(0), m_expected(0),
+    m_speed(0)
 {
   m_pool->onPush >> std::bind(&Progress::addTask, this, std::placeholders::_1);
+  m_pool->onDownloadProgress >> std::bind(&Progress::updateDownloads, this,
+    std::placeholders::_1, std::placeholders::_2);
 }
 
 void Progress::onInit()
@@ -36,6 +42,7 @@ void Progress::onInit()
 
   m_label = getControl(IDC_LABEL);
   m_progress = getControl(IDC_PROGRESS);
+  m_transfer = getControl(IDC_LABEL2);
 
   Win32::setWindowText(m_label, "Initializing...");
 }
@@ -84,6 +91,24 @@ void Progress::addTask(ThreadTask *task)
   };
 }
 
+void Progress::updateDownloads(const int64_t received, const int64_t expected)
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  if(m_lastUpdate.time_since_epoch().count()) {
+    const std::chrono::duration<double> elapsed = now - m_lastUpdate;
+    const double speed =
+      std::max<int64_t>(0, received - m_received) / elapsed.count();
+    m_speed = m_speed ? m_speed + (speed - m_speed) * SPEED_SMOOTHING : speed;
+  }
+
+  m_lastUpdate = now;
+  m_received = received;
+  m_expected = std::max(expected, received);
+
+  updateProgress();
+}
+
 void Progress::updateProgress()
 {
   Win32::setWindowText(m_label, String::format("%s %s of %s: %s",
@@ -93,8 +118,27 @@ void Progress::updateProgress()
     m_current.item.c_str()
   ).c_str());
 
-  const double pos = static_cast<double>(
+  double pos = static_cast<double>(
     std::min(m_done + 1, m_total)) / std::max(2, m_total);
+
+  if(m_expected) {
+    // tell a stalled transaction (0 bytes/s) from a slow one
+    std::string transfer = String::format("%s of %s at %s/s",
+      String::bytes(m_received).c_str(), String::bytes(m_expected).c_str(),
+      String::bytes(static_cast<int64_t>(m_speed)).c_str());
+
+    if(m_speed >= 1 && m_expected > m_received) {
+      const int64_t eta = static_cast<int64_t>((m_expected - m_received) / m_speed);
+      transfer += String::format(", %d:%02d remaining",
+        static_cast<int>(eta / 60), static_cast<int>(eta % 60));
+    }
+
+    Win32::setWindowText(m_transfer, transfer.c_str());
+
+    // bytes are a better measure of the remaining work than tasks
+    pos = static_cast<double>(m_received) / m_expected;
+  }
+
   const int percent = static_cast<int>(pos * 100);
 
   SendMessage(m_progress, PBM_SETPOS, percent, 0);
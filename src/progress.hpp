@@ -22,6 +22,8 @@
 
 #include "thread.hpp"
 
+#include <chrono>
+
 class Progress : public Dialog {
 public:
   Progress(ThreadPool *);
@@ -33,6 +35,7 @@ protected:
 
 private:
   void addTask(ThreadTask *);
+  void updateDownloads(int64_t received, int64_t expected);
   void updateProgress();
 
   ThreadPool *m_pool;
@@ -40,9 +43,15 @@ private:
 
   HWND m_label;
   HWND m_progress;
+  HWND m_transfer;
 
   int m_done;
   int m_total;
+
+  int64_t m_received;
+  int64_t m_expected;
+  double m_speed; // bytes per second
+  std::chrono::steady_clock::time_point m_lastUpdate;
 };
 
 #endif
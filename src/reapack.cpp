@@ -133,10 +133,15 @@ void ReaPack::setupAPI()
   m_api.emplace_back(&API::AddSetRepository);
   m_api.emplace_back(&API::BrowsePackages);
   m_api.emplace_back(&API::CompareVersions);
+  m_api.emplace_back(&API::CountListEntries);
   m_api.emplace_back(&API::EnumOwnedFiles);
   m_api.emplace_back(&API::FreeEntry);
+  m_api.emplace_back(&API::FreeEntryList);
   m_api.emplace_back(&API::GetEntryInfo);
+  m_api.emplace_back(&API::GetInstalledEntries);
+  m_api.emplace_back(&API::GetListEntry);
   m_api.emplace_back(&API::GetOwner);
+  m_api.emplace_back(&API::GetOwners);
   m_api.emplace_back(&API::GetRepositoryInfo);
   m_api.emplace_back(&API::ProcessQueue);
 }
@@ -389,17 +394,17 @@ void ReaPack::refreshBrowser()
 
 void ReaPack::createDirectories()
 {
-  const Path &path = Path::CACHE;
-
-  if(FS::mkdir(path))
-    return;
-
-  Win32::messageBox(Splash_GetWnd(), String::format(
-    "ReaPack could not create %s! "
-    "Please investigate or report this issue.\n\n"
-    "Error description: %s",
-    path.prependRoot().join().c_str(), FS::lastError()
-  ).c_str(), "ReaPack", MB_OK);
+  for(const Path &path : {Path::CACHE, Path::STORE}) {
+    if(FS::mkdir(path))
+      continue;
+
+    Win32::messageBox(Splash_GetWnd(), String::format(
+      "ReaPack could not create %s! "
+      "Please investigate or report this issue.\n\n"
+      "Error description: %s",
+      path.prependRoot().join().c_str(), FS::lastError()
+    ).c_str(), "ReaPack", MB_OK);
+  }
 }
 
 void ReaPack::registerSelf()
@@ -412,11 +417,21 @@ void ReaPack::registerSelf()
   ver.setAuthor("cfillion");
   ver.addSource(new Source(REAPACK_FILENAME, "dummy url", &ver));
 
+  const Path &path = Path::REGISTRY.prependRoot();
+
   try {
-    Registry reg(Path::REGISTRY.prependRoot());
+    // avoid locking or modifying the database file at every startup
+    const Registry reg(path, Registry::ReadOnly);
     const Registry::Entry &entry = reg.getEntry(&pkg);
     if(entry && entry.version == ver.name())
-      return; // avoid modifying the database file at every startup
+      return;
+  }
+  catch(const reapack_error &) {
+    // no registry yet or its schema needs to be upgraded
+  }
+
+  try {
+    Registry reg(path);
     reg.push(&ver);
     reg.commit();
   }
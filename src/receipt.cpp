@@ -84,6 +84,11 @@ ReceiptPage Receipt::errorPage() const
   return {m_errors, "Error", "Errors"};
 }
 
+ReceiptPage Receipt::networkPage() const
+{
+  return {m_network.hosts(), "Network"};
+}
+
 void ReceiptPage::setTitle(const char *title)
 {
   m_title = String::format("%s (%s)", title, String::number(m_size).c_str());
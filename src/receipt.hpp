@@ -20,6 +20,7 @@
 
 #include "registry.hpp"
 #include "errors.hpp"
+#include "telemetry.hpp"
 
 #include <memory>
 #include <set>
@@ -62,11 +63,14 @@ public:
   void addRemoval(const Path &p);
   void addExport(const Path &p);
   void addError(const ErrorInfo &);
+  void addTransfer(const TransferStats &t) { m_network.add(t); }
+  const NetworkStats &network() const { return m_network; }
 
   ReceiptPage installedPage() const;
   ReceiptPage removedPage() const;
   ReceiptPage exportedPage() const;
   ReceiptPage errorPage() const;
+  ReceiptPage networkPage() const;
 
 private:
   int m_flags;
@@ -75,6 +79,7 @@ private:
   std::set<Path> m_removals;
   std::set<Path> m_exports;
   std::vector<ErrorInfo> m_errors;
+  NetworkStats m_network;
 };
 
 class ReceiptPage {
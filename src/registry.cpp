@@ -21,49 +21,63 @@
 #include "index.hpp"
 #include "package.hpp"
 #include "path.hpp"
+#include "registry_cache.hpp"
 #include "remote.hpp"
 
 #include <algorithm>
 
 #include <sqlite3.h>
 
-Registry::Registry(const Path &path)
-  : m_db(path.join())
+Registry::Registry(const Path &path, const Mode mode)
+  : m_db(path.join(), mode == ReadOnly ? Database::ReadOnlyFlag : 0)
 {
-  migrate();
+  if(mode == ReadWrite)
+    migrate();
 
-  // entry queries
+  // queries
+  m_allEntries = m_db.prepare(
+    "SELECT id, remote, category, package, desc, type,"
+    "  version, version_segments, author, flags "
+    "FROM entries WHERE remote = ?"
+  );
+  m_getOwner = m_db.prepare(
+    "SELECT e.id, remote, category, package, desc, e.type,"
+    "  version, version_segments, author, flags "
+    "FROM entries e JOIN files f ON f.entry = e.id WHERE f.path = ? LIMIT 1"
+  );
+  m_getFiles = m_db.prepare(
+    "SELECT path, main, type FROM files WHERE entry = ? ORDER BY path"
+  );
+  m_getOutdated = m_db.prepare(
+    "SELECT id, remote, category, package, desc, type,"
+    "  version, version_segments, author, flags "
+    "FROM entries WHERE remote = ? AND category = ? AND package = ? AND version_key < ?"
+  );
+
+  if(mode == ReadOnly) {
+    // without a lock, reading from the last committed state
+    m_insertEntry = m_updateEntry = m_setFlags = m_forgetEntry =
+      m_insertFile = m_clearFiles = m_forgetFiles = nullptr;
+    return;
+  }
+
+  // entry updates
   m_insertEntry = m_db.prepare(
-    "INSERT INTO entries(remote, category, package, desc, type, version, author, flags)"
-    "VALUES(?, ?, ?, ?, ?, ?, ?, ?);"
+    "INSERT INTO entries(remote, category, package, desc, type,"
+    "  version, version_key, version_segments, author, flags)"
+    "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"
   );
 
   m_updateEntry = m_db.prepare(
     "UPDATE entries "
-    "SET desc = ?, type = ?, version = ?, author = ?, flags = ? WHERE id = ?"
+    "SET desc = ?, type = ?, version = ?, version_key = ?, version_segments = ?,"
+    "  author = ?, flags = ? WHERE id = ?"
   );
 
   m_setFlags = m_db.prepare("UPDATE entries SET flags = ? WHERE id = ?");
-
-  m_findEntry = m_db.prepare(
-    "SELECT id, remote, category, package, desc, type, version, author, flags "
-    "FROM entries WHERE remote = ? AND category = ? AND package = ? LIMIT 1"
-  );
-
-  m_allEntries = m_db.prepare(
-    "SELECT id, remote, category, package, desc, type, version, author, flags "
-    "FROM entries WHERE remote = ?"
-  );
   m_forgetEntry = m_db.prepare("DELETE FROM entries WHERE id = ?");
 
-  // file queries
-  m_getOwner = m_db.prepare(
-    "SELECT e.id, remote, category, package, desc, e.type, version, author, flags "
-    "FROM entries e JOIN files f ON f.entry = e.id WHERE f.path = ? LIMIT 1"
-  );
-  m_getFiles = m_db.prepare(
-    "SELECT path, main, type FROM files WHERE entry = ? ORDER BY path"
-  );
+  // file updates
   m_insertFile = m_db.prepare("INSERT INTO files VALUES(NULL, ?, ?, ?, ?)");
   m_clearFiles = m_db.prepare(
     "DELETE FROM files WHERE entry = ("
@@ -78,7 +92,7 @@ Registry::Registry(const Path &path)
 
 void Registry::migrate()
 {
-  const Database::Version version{0, 6};
+  const Database::Version version{0, 8};
   const Database::Version &current = m_db.version();
 
   if(!current) {
@@ -92,6 +106,8 @@ void Registry::migrate()
       "  desc TEXT NOT NULL,"
       "  type INTEGER NOT NULL,"
       "  version TEXT NOT NULL,"
+      "  version_key BLOB NOT NULL DEFAULT x''," // see VersionName::sortKey
+      "  version_segments BLOB NOT NULL DEFAULT x''," // see VersionName::segmentData
       "  author TEXT NOT NULL,"
       "  flags INTEGER DEFAULT 0,"
       "  UNIQUE(remote, category, package)"
@@ -138,6 +154,13 @@ void Registry::migrate()
       [[fallthrough]];
     case 5:
       m_db.exec("ALTER TABLE entries RENAME COLUMN pinned TO flags;");
+      [[fallthrough]];
+    case 6:
+      m_db.exec("ALTER TABLE entries ADD COLUMN version_key BLOB NOT NULL DEFAULT x'';");
+      [[fallthrough]];
+    case 7:
+      m_db.exec("ALTER TABLE entries ADD COLUMN version_segments BLOB NOT NULL DEFAULT x'';");
+      fillVersionKeys();
       break;
     }
 
@@ -170,6 +193,8 @@ auto Registry::push(const Version *ver, const int flags,
     m_updateEntry->bind(col++, pkg->description());
     m_updateEntry->bind(col++, pkg->type());
     m_updateEntry->bind(col++, ver->name().toString());
+    m_updateEntry->bindBlob(col++, ver->name().sortKey());
+    m_updateEntry->bindBlob(col++, ver->name().segmentData());
     m_updateEntry->bind(col++, ver->author());
     m_updateEntry->bind(col++, flags);
     m_updateEntry->bind(col++, entryId);
@@ -183,6 +208,8 @@ auto Registry::push(const Version *ver, const int flags,
     m_insertEntry->bind(col++, pkg->description());
     m_insertEntry->bind(col++, pkg->type());
     m_insertEntry->bind(col++, ver->name().toString());
+    m_insertEntry->bindBlob(col++, ver->name().sortKey());
+    m_insertEntry->bindBlob(col++, ver->name().segmentData());
     m_insertEntry->bind(col++, ver->author());
     m_insertEntry->bind(col++, flags);
     m_insertEntry->exec();
@@ -221,10 +248,15 @@ auto Registry::push(const Version *ver, const int flags,
   }
   else {
     m_db.release();
-    return {
+
+    const Entry entry{
       entryId, ri->name(), cat->name(), pkg->name(), pkg->description(),
       pkg->type(), ver->name(), ver->author(), flags
     };
+
+    entryMap(entry.remote)[entryKey(entry.category, entry.package)] = entry;
+
+    return entry;
   }
 }
 
@@ -233,25 +265,62 @@ void Registry::setFlags(const Entry &entry, const int flags)
   m_setFlags->bind(1, flags);
   m_setFlags->bind(2, entry.id);
   m_setFlags->exec();
+
+  if(Entry *cached = cachedEntry(entry))
+    cached->flags = flags;
 }
 
 auto Registry::getEntry(const Package *pkg) const -> Entry
 {
-  Entry entry{};
-
   const Category *cat = pkg->category();
   const Index *ri = cat->index();
 
-  m_findEntry->bind(1, ri->name());
-  m_findEntry->bind(2, cat->name());
-  m_findEntry->bind(3, pkg->name());
+  const EntryMap &entries = entryMap(ri->name());
+  const auto &it = entries.find(entryKey(cat->name(), pkg->name()));
 
-  m_findEntry->exec([&] {
-    fillEntry(m_findEntry, &entry);
-    return false;
-  });
+  return it != entries.end() ? it->second : Entry{};
+}
 
-  return entry;
+auto Registry::entryMap(const std::string &remote) const -> EntryMap &
+{
+  const auto &[it, inserted] = m_entryMaps.try_emplace(remote);
+  EntryMap &entries = it->second;
+
+  if(inserted) {
+    m_allEntries->bind(1, remote);
+    m_allEntries->exec([&] {
+      Entry entry{};
+      fillEntry(m_allEntries, &entry);
+      entries.emplace(entryKey(entry.category, entry.package), entry);
+
+      return true;
+    });
+  }
+
+  return entries;
+}
+
+auto Registry::cachedEntry(const Entry &entry) const -> Entry *
+{
+  const auto &remoteIt = m_entryMaps.find(entry.remote);
+  if(remoteIt == m_entryMaps.end())
+    return nullptr;
+
+  EntryMap &entries = remoteIt->second;
+  const auto &it = entries.find(entryKey(entry.category, entry.package));
+  return it != entries.end() ? &it->second : nullptr;
+}
+
+std::string Registry::entryKey(const std::string &category, const std::string &package)
+{
+  // NUL cannot appear in the names read from an XML index
+  std::string key;
+  key.reserve(category.size() + 1 + package.size());
+  key += category;
+  key += '\0';
+  key += package;
+
+  return key;
 }
 
 auto Registry::getEntries(const std::string &remoteName) const -> std::vector<Entry>
@@ -270,6 +339,45 @@ auto Registry::getEntries(const std::string &remoteName) const -> std::vector<En
   return list;
 }
 
+auto Registry::getAllEntries() const -> std::vector<Entry>
+{
+  std::vector<Entry> list;
+
+  Statement stmt(
+    "SELECT id, remote, category, package, desc, type,"
+    "  version, version_segments, author, flags "
+    "FROM entries", &m_db);
+
+  stmt.exec([&] {
+    Entry entry{};
+    fillEntry(&stmt, &entry);
+    list.push_back(entry);
+
+    return true;
+  });
+
+  return list;
+}
+
+void Registry::getAllFiles(const std::function<void (Entry::id_t, File &&)> &callback) const
+{
+  Statement stmt("SELECT entry, path, main, type FROM files ORDER BY path", &m_db);
+
+  stmt.exec([&] {
+    int col = 0;
+
+    const Entry::id_t entry = stmt.intColumn(col++);
+    File file{
+      stmt.stringColumn(col++),
+      static_cast<int>(stmt.intColumn(col++)),
+      static_cast<Package::Type>(stmt.intColumn(col++)),
+    };
+
+    callback(entry, std::move(file));
+    return true;
+  });
+}
+
 auto Registry::getFiles(const Entry &entry) const -> std::vector<File>
 {
   if(!entry) // skip processing for new packages
@@ -325,6 +433,53 @@ auto Registry::getOwner(const Path &path) const -> Entry
   return entry;
 }
 
+auto Registry::getOutdated(const Version *ver) const -> Entry
+{
+  const Package *pkg = ver->package();
+  const Category *cat = pkg->category();
+
+  Entry entry{};
+
+  m_getOutdated->bind(1, cat->index()->name());
+  m_getOutdated->bind(2, cat->name());
+  m_getOutdated->bind(3, pkg->name());
+  m_getOutdated->bindBlob(4, ver->name().sortKey());
+
+  m_getOutdated->exec([&] {
+    fillEntry(m_getOutdated, &entry);
+    return false;
+  });
+
+  return entry;
+}
+
+void Registry::readConsistent(const std::function<void ()> &reads) const
+{
+  // starts a deferred read transaction unless one is already active
+  Statement begin("SAVEPOINT read_consistent", &m_db),
+    end("RELEASE SAVEPOINT read_consistent", &m_db);
+
+  begin.exec();
+
+  try {
+    reads();
+  }
+  catch(const reapack_error &) {
+    end.exec();
+    throw;
+  }
+
+  end.exec();
+}
+
+void Registry::commit()
+{
+  m_db.commit();
+
+  // the API's copy of the registry is now outdated
+  RegistryCache::invalidate();
+}
+
 void Registry::forget(const Entry &entry)
 {
   m_forgetFiles->bind(1, entry.id);
@@ -332,6 +487,9 @@ void Registry::forget(const Entry &entry)
 
   m_forgetEntry->bind(1, entry.id);
   m_forgetEntry->exec();
+
+  if(const auto &it = m_entryMaps.find(entry.remote); it != m_entryMaps.end())
+    it->second.erase(entryKey(entry.category, entry.package));
 }
 
 void Registry::convertImplicitSections()
@@ -353,6 +511,25 @@ void Registry::convertImplicitSections()
   });
 }
 
+void Registry::fillVersionKeys()
+{
+  Statement entries("SELECT id, version FROM entries", &m_db);
+  Statement update(
+    "UPDATE entries SET version_key = ?, version_segments = ? WHERE id = ?", &m_db);
+
+  entries.exec([&] {
+    VersionName version;
+    version.tryParse(entries.stringColumn(1));
+
+    update.bindBlob(1, version.sortKey());
+    update.bindBlob(2, version.segmentData());
+    update.bind(3, entries.intColumn(0));
+    update.exec();
+
+    return true;
+  });
+}
+
 void Registry::fillEntry(const Statement *stmt, Entry *entry) const
 {
   int col = 0;
@@ -363,7 +540,9 @@ void Registry::fillEntry(const Statement *stmt, Entry *entry) const
   entry->package = stmt->stringColumn(col++);
   entry->description = stmt->stringColumn(col++);
   entry->type = static_cast<Package::Type>(stmt->intColumn(col++));
-  entry->version.tryParse(stmt->stringColumn(col++));
+  const std::string &version = stmt->stringColumn(col++);
+  if(!entry->version.restore(version, stmt->blobColumn(col++)))
+    entry->version.tryParse(version);
   entry->author = stmt->stringColumn(col++);
   entry->flags = static_cast<int>(stmt->intColumn(col++));
 }
@@ -19,12 +19,15 @@
 #define REAPACK_REGISTRY_HPP
 
 #include "database.hpp"
+#include "intern.hpp"
 #include "package.hpp"
 #include "path.hpp"
 #include "version.hpp"
 
+#include <functional>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 class Registry {
 public:
@@ -37,13 +40,13 @@ public:
     typedef int64_t id_t;
 
     id_t id;
-    std::string remote;
-    std::string category;
+    InternedString remote;
+    InternedString category;
     std::string package;
     std::string description;
     Package::Type type;
     VersionName version;
-    std::string author;
+    InternedString author;
     int flags;
 
     operator bool() const { return id > 0; }
@@ -59,39 +62,66 @@ public:
     bool operator<(const File &o) const { return path < o.path; }
   };
 
-  Registry(const Path &path = {});
+  enum Mode {
+    ReadWrite, // migrates the schema and locks the database until commit()
+    ReadOnly,  // for the const members only, never waits for a writer
+  };
+
+  Registry(const Path &path = {}, Mode = ReadWrite);
 
+  // the entries of a repository are read in a single query on first use
+  // and kept up to date by push(), setFlags() and forget()
   Entry getEntry(const Package *) const;
   Entry getOwner(const Path &) const;
+  // installed entry of the version's package if it is older than that version,
+  // compared by the database using the stored version keys
+  Entry getOutdated(const Version *) const;
   std::vector<Entry> getEntries(const std::string &) const;
+  std::vector<Entry> getAllEntries() const;
   std::vector<File> getFiles(const Entry &) const;
+  // every file of every entry in a single query, sorted by path
+  void getAllFiles(const std::function<void (Entry::id_t, File &&)> &) const;
   std::vector<File> getMainFiles(const Entry &) const;
   Entry push(const Version *, int flags = 0, std::vector<Path> *conflicts = nullptr);
   void setFlags(const Entry &, int flags);
   void forget(const Entry &);
 
+  // runs the given reads against a single state of the database,
+  // other connections cannot commit changes in between
+  void readConsistent(const std::function<void ()> &) const;
+
   void savepoint() { m_db.savepoint(); }
-  void restore() { m_db.restore(); }
-  void commit() { m_db.commit(); }
+  void restore() { m_db.restore(); m_entryMaps.clear(); }
+  void commit();
 
 private:
+  typedef std::unordered_map<std::string, Entry> EntryMap;
+
+  static std::string entryKey(const std::string &category, const std::string &package);
+
   void migrate();
   void convertImplicitSections();
+  void fillVersionKeys();
   void fillEntry(const Statement *, Entry *) const;
+  EntryMap &entryMap(const std::string &remote) const;
+  Entry *cachedEntry(const Entry &) const;
 
   Database m_db;
   Statement *m_insertEntry;
   Statement *m_updateEntry;
   Statement *m_setFlags;
-  Statement *m_findEntry;
   Statement *m_allEntries;
   Statement *m_forgetEntry;
   Statement *m_getOwner;
+  Statement *m_getOutdated;
 
   Statement *m_getFiles;
   Statement *m_insertFile;
   Statement *m_clearFiles;
   Statement *m_forgetFiles;
+
+  // by remote name, then by category and package (see entryKey)
+  mutable std::unordered_map<std::string, EntryMap> m_entryMaps;
 };
 
 namespace std {
@@ -0,0 +1,84 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "registry_cache.hpp"
+
+#include "path.hpp"
+
+#include <mutex>
+
+static std::mutex s_mutex;
+static RegistryCachePtr s_current;
+
+RegistryCachePtr RegistryCache::get()
+{
+  std::lock_guard<std::mutex> guard(s_mutex);
+
+  if(!s_current) {
+    const Registry reg(Path::REGISTRY.prependRoot(), Registry::ReadOnly);
+    s_current = std::make_shared<RegistryCache>(reg);
+  }
+
+  return s_current;
+}
+
+void RegistryCache::invalidate()
+{
+  // copies still in use remain valid until released
+  std::lock_guard<std::mutex> guard(s_mutex);
+  s_current.reset();
+}
+
+RegistryCache::RegistryCache(const Registry &reg)
+{
+  std::unordered_map<Registry::Entry::id_t, size_t> indexes;
+
+  // the files must belong to the same state of the registry as the entries
+  reg.readConsistent([&] {
+    m_entries = reg.getAllEntries();
+
+    for(size_t i = 0; i < m_entries.size(); ++i)
+      indexes[m_entries[i].id] = i;
+
+    reg.getAllFiles([&] (const Registry::Entry::id_t entry, Registry::File &&file) {
+      const auto &it = indexes.find(entry);
+      if(it == indexes.end())
+        return;
+
+      if(!file.type) // < v1.0rc2
+        file.type = m_entries[it->second].type;
+
+      m_owners.emplace(file.path.join(false), it->second);
+      m_files[entry].push_back(std::move(file));
+    });
+  });
+}
+
+Registry::Entry RegistryCache::getOwner(const Path &path) const
+{
+  const auto &it = m_owners.find(path.join(false));
+  return it != m_owners.end() ? m_entries[it->second] : Registry::Entry{};
+}
+
+auto RegistryCache::getFiles(const Registry::Entry &entry) const
+  -> const std::vector<Registry::File> &
+{
+  static const std::vector<Registry::File> none;
+
+  const auto &it = m_files.find(entry.id);
+  return it != m_files.end() ? it->second : none;
+}
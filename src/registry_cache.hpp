@@ -0,0 +1,51 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_REGISTRY_CACHE_HPP
+#define REAPACK_REGISTRY_CACHE_HPP
+
+#include "registry.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RegistryCache;
+typedef std::shared_ptr<const RegistryCache> RegistryCachePtr;
+
+// In-memory copy of the installed entries and their files, for answering
+// frequent lookups (such as the API's) without touching the database.
+// It is read once and shared until a registry commits new changes.
+class RegistryCache {
+public:
+  static RegistryCachePtr get(); // throws reapack_error
+  static void invalidate();
+
+  RegistryCache(const Registry &);
+
+  const std::vector<Registry::Entry> &entries() const { return m_entries; }
+  Registry::Entry getOwner(const Path &) const;
+  const std::vector<Registry::File> &getFiles(const Registry::Entry &) const;
+
+private:
+  std::vector<Registry::Entry> m_entries;
+  std::unordered_map<Registry::Entry::id_t, std::vector<Registry::File>> m_files;
+  std::unordered_map<std::string, size_t> m_owners; // path -> entry index
+};
+
+#endif
@@ -41,6 +41,7 @@ void Report::onInit()
     m_receipt->removedPage(),
     m_receipt->exportedPage(),
     m_receipt->errorPage(),
+    m_receipt->networkPage(),
   };
 
   for(const auto &page : pages)
@@ -56,11 +56,15 @@ auto Source::detectSection(const Path &category) -> Section
 }
 
 Source::Source(const std::string &file, const std::string &url, const Version *ver)
-  : m_type(Package::UnknownType), m_file(file), m_url(url), m_sections(0),
-    m_version(ver)
+  : m_type(Package::UnknownType), m_file(file), m_size(0),
+    m_sections(0), m_version(ver)
 {
-  if(m_url.empty())
+  if(url.empty())
     throw reapack_error("empty source url");
+
+  const size_t split = url.rfind('/') + 1;
+  m_urlPrefix = url.substr(0, split);
+  m_urlSuffix = url.substr(split);
 }
 
 Package::Type Source::type() const
@@ -47,12 +47,15 @@ public:
   const Version *version() const { return m_version; }
   Package::Type type() const;
   const std::string &file() const;
-  const std::string &url() const { return m_url; }
+  std::string url() const { return m_urlPrefix.str() + m_urlSuffix; }
   Path targetPath() const;
 
   void setChecksum(const std::string &checksum) { m_checksum = checksum; }
   const std::string &checksum() const { return m_checksum; }
 
+  void setSize(int64_t size) { m_size = size; }
+  int64_t size() const { return m_size; } // in bytes, 0 if unknown
+
   void setPlatform(Platform p) { m_platform = p; }
   Platform platform() const { return m_platform; }
 
@@ -66,8 +69,10 @@ private:
   Platform m_platform;
   Package::Type m_type;
   std::string m_file;
-  std::string m_url;
+  InternedString m_urlPrefix; // up to the last slash, shared with other sources
+  std::string m_urlSuffix;
   std::string m_checksum;
+  int64_t m_size;
   int m_sections;
   Path m_targetPath;
   const Version *m_version;
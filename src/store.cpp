@@ -0,0 +1,279 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "store.hpp"
+
+#include "errors.hpp"
+#include "filesystem.hpp"
+#include "hash.hpp"
+
+#include <fstream>
+
+static bool isValid(const std::string &checksum)
+{
+  // the checksum becomes a file name: don't let it contain anything but hex
+  Hash::Algorithm algo;
+  return Hash::getAlgorithm(checksum, &algo) &&
+    checksum.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+}
+
+Path Store::pathFor(const std::string &checksum)
+{
+  // skip the multihash prefix (algorithm and digest size) for the fan-out
+  Path path = Path::STORE;
+  path.append(checksum.substr(4, 2), false);
+  path.append(checksum, false);
+  return path;
+}
+
+Store::Store(const Path &path)
+  : m_db(path.join())
+{
+  migrate();
+
+  m_findObject = m_db.prepare("SELECT 1 FROM objects WHERE checksum = ? LIMIT 1");
+  m_touchObject = m_db.prepare(
+    "UPDATE objects SET used = (SELECT MAX(used) + 1 FROM objects) "
+    "WHERE checksum = ?"
+  );
+  m_insertObject = m_db.prepare(
+    "INSERT OR REPLACE INTO objects(checksum, size, used) "
+    "VALUES(?, ?, (SELECT IFNULL(MAX(used), 0) + 1 FROM objects))"
+  );
+  m_removeObject = m_db.prepare("DELETE FROM objects WHERE checksum = ?");
+  m_allObjects = m_db.prepare(
+    "SELECT checksum, size FROM objects ORDER BY used DESC"
+  );
+  m_findSize = m_db.prepare("SELECT size FROM sizes WHERE file = ? LIMIT 1");
+  m_insertSize = m_db.prepare(
+    "INSERT OR REPLACE INTO sizes(file, size) VALUES(?, ?)");
+
+  // lock the database
+  m_db.begin();
+}
+
+void Store::migrate()
+{
+  const Database::Version version{0, 2};
+  const Database::Version &current = m_db.version();
+
+  if(!current) {
+    m_db.exec(
+      "CREATE TABLE objects ("
+      "  checksum TEXT PRIMARY KEY,"
+      "  size INTEGER NOT NULL,"
+      "  used INTEGER NOT NULL"
+      ");"
+    );
+  }
+  else if(version < current)
+    throw reapack_error("The package store was created by a newer version of ReaPack");
+  else if(!(current < version))
+    return;
+
+  switch(current.minor) {
+  case 0:
+  case 1:
+    m_db.exec(
+      "CREATE TABLE sizes ("
+      "  file TEXT PRIMARY KEY,"
+      "  size INTEGER NOT NULL"
+      ");"
+    );
+    break;
+  }
+
+  m_db.setVersion(version);
+}
+
+Path Store::find(const std::string &checksum)
+{
+  if(!isValid(checksum))
+    return {};
+
+  bool found = false;
+
+  m_findObject->bind(1, checksum);
+  m_findObject->exec([&] {
+    found = true;
+    return false;
+  });
+
+  if(!found)
+    return {};
+
+  const Path &path = pathFor(checksum);
+
+  if(!FS::exists(path)) {
+    remove(checksum);
+    return {};
+  }
+
+  m_touchObject->bind(1, checksum);
+  m_touchObject->exec();
+
+  return path;
+}
+
+FileCopy *Store::add(const Path &file, const std::string &checksum)
+{
+  if(!isValid(checksum))
+    return nullptr;
+
+  FileCopy *job = new FileCopy(file, pathFor(checksum), checksum);
+
+  job->onFinishAsync >> [=] {
+    if(job->state() == ThreadTask::Success && FS::rename(job->path()))
+      insert(checksum, job->size());
+    else
+      FS::remove(job->path().temp());
+  };
+
+  return job;
+}
+
+void Store::insert(const std::string &checksum, const int64_t size)
+{
+  m_insertObject->bind(1, checksum);
+  m_insertObject->bind(2, size);
+  m_insertObject->exec();
+}
+
+void Store::remove(const std::string &checksum)
+{
+  FS::remove(pathFor(checksum));
+
+  m_removeObject->bind(1, checksum);
+  m_removeObject->exec();
+}
+
+void Store::trim(const int64_t maxSize)
+{
+  std::vector<std::string> evicted;
+  int64_t total = 0;
+
+  // keep the most recently used objects that fit in the allowed size
+  m_allObjects->exec([&] {
+    total += m_allObjects->intColumn(1);
+
+    if(total > maxSize)
+      evicted.push_back(m_allObjects->stringColumn(0));
+
+    return true;
+  });
+
+  for(const std::string &checksum : evicted)
+    remove(checksum);
+}
+
+int64_t Store::sizeHint(const Path &file) const
+{
+  int64_t size = 0;
+
+  m_findSize->bind(1, file.join(false));
+  m_findSize->exec([&] {
+    size = m_findSize->intColumn(0);
+    return false;
+  });
+
+  return size;
+}
+
+void Store::setSizeHint(const Path &file, const int64_t size)
+{
+  m_insertSize->bind(1, file.join(false));
+  m_insertSize->bind(2, size);
+  m_insertSize->exec();
+}
+
+int64_t Store::size() const
+{
+  int64_t total = 0;
+
+  m_allObjects->exec([&] {
+    total += m_allObjects->intColumn(1);
+    return true;
+  });
+
+  return total;
+}
+
+FileCopy::FileCopy(const Path &source, const Path &target,
+    const std::string &checksum)
+  : m_source(source), m_path(target), m_checksum(checksum), m_size(0),
+    m_corruptSource(false)
+{
+  setSummary({ "Copying", target.join() });
+}
+
+bool FileCopy::run()
+{
+  Hash::Algorithm algo;
+  if(!Hash::getAlgorithm(m_checksum, &algo)) {
+    setError({String::format("Unsupported checksum: %s", m_checksum.c_str()),
+      m_source.join()});
+    return false;
+  }
+
+  std::ifstream in;
+  if(!FS::open(in, m_source)) {
+    setError({FS::lastError(), m_source.join()});
+    m_corruptSource = true;
+    return false;
+  }
+
+  std::ofstream out;
+  if(!FS::open(out, m_path.temp())) {
+    setError({FS::lastError(), m_path.temp().join()});
+    return false;
+  }
+
+  Hash hash(algo);
+  char buffer[65536];
+
+  while(!aborted() && in) {
+    in.read(buffer, sizeof(buffer));
+    const std::streamsize count = in.gcount();
+
+    hash.addData(buffer, count);
+    out.write(buffer, count);
+    m_size += count;
+  }
+
+  out.close();
+
+  if(in.bad()) {
+    setError({"Could not read the file", m_source.join()});
+    m_corruptSource = true;
+    return false;
+  }
+  else if(!out) {
+    setError({"Could not copy the file", m_path.target().join()});
+    return false;
+  }
+  else if(hash.digest() != m_checksum) {
+    const std::string &err = String::format(
+      "Checksum mismatch.\nExpected: %s\nActual: %s",
+      m_checksum.c_str(), hash.digest().c_str()
+    );
+    setError({err, m_source.join()});
+    m_corruptSource = !aborted();
+    return false;
+  }
+
+  return true;
+}
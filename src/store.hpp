@@ -0,0 +1,83 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_STORE_HPP
+#define REAPACK_STORE_HPP
+
+#include "database.hpp"
+#include "path.hpp"
+#include "thread.hpp"
+
+#include <string>
+
+class FileCopy;
+
+// Content-addressable copies of the files previously downloaded,
+// identified by their multihash checksum.
+class Store {
+public:
+  static Path pathFor(const std::string &checksum);
+
+  Store(const Path &database = {});
+
+  Path find(const std::string &checksum);
+  FileCopy *add(const Path &file, const std::string &checksum);
+  void remove(const std::string &checksum);
+  void trim(int64_t maxSize);
+  int64_t size() const;
+
+  // sizes of the previous downloads of an installed file
+  int64_t sizeHint(const Path &file) const;
+  void setSizeHint(const Path &file, int64_t size);
+
+  void commit() { m_db.commit(); }
+
+private:
+  void migrate();
+  void insert(const std::string &checksum, int64_t size);
+
+  Database m_db;
+  Statement *m_findObject;
+  Statement *m_touchObject;
+  Statement *m_insertObject;
+  Statement *m_removeObject;
+  Statement *m_allObjects;
+  Statement *m_findSize;
+  Statement *m_insertSize;
+};
+
+class FileCopy : public ThreadTask {
+public:
+  FileCopy(const Path &source, const Path &target, const std::string &checksum);
+
+  const TempPath &path() const { return m_path; }
+  int64_t size() const { return m_size; }
+  // the source could not be read or did not match the expected checksum
+  bool corruptSource() const { return m_corruptSource; }
+
+  bool concurrent() const override { return true; }
+  bool run() override;
+
+private:
+  Path m_source;
+  TempPath m_path;
+  std::string m_checksum;
+  int64_t m_size;
+  bool m_corruptSource;
+};
+
+#endif
@@ -40,6 +40,23 @@ std::string String::format(const char *fmt, ...)
   return buf;
 }
 
+std::string String::bytes(const int64_t size)
+{
+  constexpr const char *units[] { "KB", "MB", "GB" };
+
+  if(size < 1024)
+    return format("%d bytes", static_cast<int>(size));
+
+  double value = static_cast<double>(size) / 1024;
+  size_t unit = 0;
+  while(value >= 1024 && unit + 1 < std::size(units)) {
+    value /= 1024;
+    ++unit;
+  }
+
+  return format("%.1f %s", value, units[unit]);
+}
+
 std::string String::indent(const std::string &text)
 {
   std::string output;
@@ -18,6 +18,7 @@
 #ifndef REAPACK_STRING_HPP
 #define REAPACK_STRING_HPP
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 
@@ -32,6 +33,7 @@ namespace String {
   std::string format(const char *fmt, ...);
 
   std::string indent(const std::string &);
+  std::string bytes(int64_t);
   std::string stripRtf(const std::string &);
 
   template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
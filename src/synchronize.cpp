@@ -19,14 +19,55 @@
 
 #include "config.hpp"
 #include "download.hpp"
+#include "errors.hpp"
 #include "filesystem.hpp"
 #include "index.hpp"
 #include "reapack.hpp"
+#include "string.hpp"
 #include "transaction.hpp"
+#include "xml.hpp"
+
+#include <algorithm>
+
+IndexLoader::IndexLoader(const std::string &name)
+  : m_name(name)
+{
+  setSummary({ "Loading", name });
+}
+
+IndexLoader::IndexLoader(const std::string &name,
+    std::unique_ptr<XmlDocument> &&doc)
+  : IndexLoader(name)
+{
+  m_document = std::move(doc);
+}
+
+IndexLoader::~IndexLoader() = default;
+
+bool IndexLoader::run()
+{
+  try {
+    if(m_document) {
+      m_index = Index::load(m_name, *m_document);
+      m_document.reset();
+      m_index->saveSnapshot();
+    }
+    else
+      m_index = Index::load(m_name);
+
+    return true;
+  }
+  catch(const reapack_error &e) {
+    setError({String::format("Could not load repository: %s", e.what()), m_name});
+    return false;
+  }
+}
 
 SynchronizeTask::SynchronizeTask(const Remote &remote, const bool stale,
     const bool fullSync, const InstallOpts &opts, Transaction *tx)
-  : Task(tx), m_remote(remote), m_indexPath(Index::pathFor(m_remote.name())),
+  : Task(tx), m_remote(remote),
+    m_indexPath(Index::pathFor(m_remote.name())),
+    m_validatorsPath(Index::validatorsPathFor(m_remote.name())),
     m_opts(opts), m_stale(stale), m_fullSync(fullSync)
 {
 }
@@ -35,32 +76,73 @@ bool SynchronizeTask::start()
 {
   const auto &netConfig = g_reapack->config()->network;
 
-  time_t mtime = 0, now = time(nullptr);
+  time_t mtime = 0, checked = 0, now = time(nullptr);
   FS::mtime(m_indexPath, &mtime);
 
+  // revalidations don't modify the index, keeping its snapshot usable
+  if(mtime && FS::mtime(m_validatorsPath, &checked))
+    checked = std::max(mtime, checked);
+  else
+    checked = mtime;
+
   const time_t threshold = netConfig.staleThreshold;
-  if(!m_stale && mtime && (!threshold || mtime > now - threshold))
+  if(!m_stale && mtime && (!threshold || checked > now - threshold)) {
+    loadIndex();
     return true;
+  }
 
-  auto dl = new FileDownload(m_indexPath, m_remote.url(),
+  auto dl = new IndexDownload(m_indexPath, m_remote.url(),
     netConfig, Download::NoCacheFlag);
   dl->setName(m_remote.name());
 
+  // only ask for the changes if we still have the previous copy
+  if(mtime)
+    dl->setValidators(Download::Validators::read(m_validatorsPath));
+
   dl->onFinishAsync >> [=] {
-    if(dl->save())
+    if(dl->notModified()) {
+      FS::touch(m_validatorsPath); // reset the staleness countdown
+      dl->save(); // discard the empty temporary file
+    }
+    else if(dl->save()) {
+      dl->validators().write(m_validatorsPath);
       tx()->receipt()->setIndexChanged();
+
+      // already parsed during the download
+      if(auto doc = dl->takeDocument(); doc && *doc) {
+        loadIndex(std::move(doc));
+        return;
+      }
+    }
+
+    if(dl->state() != ThreadTask::Aborted)
+      loadIndex();
   };
 
   tx()->threadPool()->push(dl);
   return true;
 }
 
-void SynchronizeTask::commit()
+void SynchronizeTask::loadIndex(std::unique_ptr<XmlDocument> &&doc)
 {
-  if(!FS::exists(m_indexPath))
+  if(!doc && !FS::exists(m_indexPath))
     return;
 
-  const IndexPtr &index = tx()->loadIndex(m_remote); // TODO: reuse m_indexPath
+  // parsed concurrently with the other repositories, the result is
+  // available to commit() once every task of this queue is done
+  auto loader = doc ? new IndexLoader(m_remote.name(), std::move(doc))
+                    : new IndexLoader(m_remote.name());
+  loader->onFinishAsync >> [=] {
+    if(const IndexPtr &index = loader->index())
+      tx()->setIndex(m_remote, index);
+  };
+
+  tx()->threadPool()->push(loader);
+}
+
+void SynchronizeTask::commit()
+{
+  const IndexPtr &index = tx()->index(m_remote);
   if(!index || !m_fullSync)
     return;
 
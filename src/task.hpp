@@ -22,6 +22,7 @@
 #include "path.hpp"
 #include "registry.hpp"
 #include "remote.hpp"
+#include "thread.hpp"
 
 #include <memory>
 #include <set>
@@ -30,10 +31,11 @@
 
 class ArchiveReader;
 class Index;
+class SharedFile;
 class Source;
-class ThreadTask;
 class Transaction;
 class Version;
+class XmlDocument;
 struct InstallOpts;
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
@@ -58,6 +60,25 @@ private:
   Transaction *m_tx;
 };
 
+// Reads an index from the disk in a worker thread.
+class IndexLoader : public ThreadTask {
+public:
+  IndexLoader(const std::string &name);
+  // builds the index from a document parsed during its download
+  IndexLoader(const std::string &name, std::unique_ptr<XmlDocument> &&);
+  ~IndexLoader();
+
+  const IndexPtr &index() const { return m_index; }
+
+  bool concurrent() const override { return true; }
+  bool run() override;
+
+private:
+  std::string m_name;
+  std::unique_ptr<XmlDocument> m_document;
+  IndexPtr m_index;
+};
+
 class SynchronizeTask : public Task {
 public:
   // TODO: remove InstallOpts argument
@@ -69,10 +90,12 @@ protected:
   void commit() override;
 
 private:
+  void loadIndex(std::unique_ptr<XmlDocument> && = nullptr);
   void synchronize(const Package *);
 
   Remote m_remote;
   Path m_indexPath;
+  Path m_validatorsPath;
   InstallOpts m_opts;
   bool m_stale;
   bool m_fullSync;
@@ -88,7 +111,13 @@ public:
   void rollback() override;
 
 private:
+  Path find(const Source *) const;
+  void copy(const Source *, const Path &stored);
+  void download(const Source *);
+  void store(SharedFile *);
   void push(ThreadTask *, const TempPath &);
+  // for the tasks pushed by someone else
+  void watch(ThreadTask *, const TempPath &);
 
   const Version *m_version;
   int m_flags;
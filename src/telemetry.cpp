@@ -0,0 +1,195 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "telemetry.hpp"
+
+#include "filesystem.hpp"
+#include "path.hpp"
+#include "string.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <sstream>
+
+// amount of transactions kept in the log file
+static const size_t MAX_SAVED_RUNS = 100;
+
+static std::string jsonString(const std::string &input)
+{
+  std::string output = "\"";
+
+  for(const char c : input) {
+    switch(c) {
+    case '"':
+    case '\\':
+      output += '\\';
+      output += c;
+      break;
+    default:
+      if(static_cast<unsigned char>(c) < 0x20)
+        output += String::format("\\u%04x", c);
+      else
+        output += c;
+      break;
+    }
+  }
+
+  return output += '"';
+}
+
+static std::string milliseconds(const double seconds)
+{
+  return String::format("%.0f ms", seconds * 1000);
+}
+
+HostStats::HostStats(const std::string &host)
+  : m_host(host), m_transfers(0), m_connections(0), m_bytes(0), m_dns(0),
+    m_connect(0), m_tls(0), m_firstByte(0), m_download(0), m_total(0),
+    m_slowest(0)
+{
+}
+
+void HostStats::add(const TransferStats &stats)
+{
+  ++m_transfers;
+  m_bytes += stats.size;
+
+  // each step is measured from the start: only keep what it added
+  const double connected = std::max(stats.connect, stats.appConnect);
+
+  if(!stats.reused) {
+    ++m_connections;
+    m_dns += stats.nameLookup;
+    m_connect += std::max(0.0, stats.connect - stats.nameLookup);
+    if(stats.appConnect > 0)
+      m_tls += std::max(0.0, stats.appConnect - stats.connect);
+  }
+
+  if(stats.startTransfer > 0) {
+    m_firstByte += std::max(0.0, stats.startTransfer - connected);
+    m_download += std::max(0.0, stats.total - stats.startTransfer);
+  }
+
+  m_total += stats.total;
+  m_slowest = std::max(m_slowest, stats.total);
+
+  if(!stats.httpVersion.empty())
+    ++m_httpVersions[stats.httpVersion];
+}
+
+double HostStats::speed() const
+{
+  return m_total > 0 ? m_bytes / m_total : 0;
+}
+
+std::string HostStats::toJSON() const
+{
+  std::ostringstream stream;
+  stream
+    << "{\"host\":" << jsonString(m_host)
+    << ",\"transfers\":" << m_transfers
+    << ",\"connections\":" << m_connections
+    << ",\"bytes\":" << m_bytes
+    << String::format(
+      ",\"dns\":%.4f,\"connect\":%.4f,\"tls\":%.4f,\"firstByte\":%.4f"
+      ",\"download\":%.4f,\"total\":%.4f,\"slowest\":%.4f,\"speed\":%.0f",
+      dns(), connect(), tls(), firstByte(), download(), total(), m_slowest,
+      speed())
+    << ",\"http\":{";
+
+  for(auto it = m_httpVersions.begin(); it != m_httpVersions.end(); ++it) {
+    if(it != m_httpVersions.begin())
+      stream << ',';
+    stream << jsonString(it->first) << ':' << it->second;
+  }
+
+  stream << "}}";
+  return stream.str();
+}
+
+std::ostream &operator<<(std::ostream &os, const HostStats &host)
+{
+  if(os.tellp() > 0)
+    os << "\r\n";
+
+  os << host.host() << ":\r\n  "
+     << host.transfers() << (host.transfers() == 1 ? " transfer, " : " transfers, ")
+     << String::bytes(host.bytes()) << " at "
+     << String::bytes(static_cast<int64_t>(host.speed())) << "/s\r\n  "
+     << host.connections()
+     << (host.connections() == 1 ? " new connection: " : " new connections: ")
+     << "DNS " << milliseconds(host.dns())
+     << ", connect " << milliseconds(host.connect())
+     << ", TLS " << milliseconds(host.tls()) << "\r\n  "
+     << "Average: first byte " << milliseconds(host.firstByte())
+     << ", download " << milliseconds(host.download())
+     << ", total " << milliseconds(host.total())
+     << " (slowest " << milliseconds(host.slowest()) << ')';
+
+  return os;
+}
+
+void NetworkStats::add(const TransferStats &stats)
+{
+  auto it = std::find_if(m_hosts.begin(), m_hosts.end(),
+    [&](const HostStats &host) { return host.host() == stats.host; });
+
+  if(it == m_hosts.end())
+    it = m_hosts.insert(m_hosts.end(), HostStats{stats.host});
+
+  it->add(stats);
+}
+
+std::string NetworkStats::toJSON(const time_t time) const
+{
+  std::ostringstream stream;
+  stream << "{\"time\":" << static_cast<int64_t>(time) << ",\"hosts\":[";
+
+  for(auto it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+    if(it != m_hosts.begin())
+      stream << ',';
+    stream << it->toJSON();
+  }
+
+  stream << "]}";
+  return stream.str();
+}
+
+bool NetworkStats::save(const Path &path, const time_t time) const
+{
+  std::deque<std::string> lines;
+
+  std::ifstream previous;
+  if(FS::open(previous, path)) {
+    std::string line;
+    while(std::getline(previous, line)) {
+      lines.push_back(line);
+      if(lines.size() >= MAX_SAVED_RUNS)
+        lines.pop_front();
+    }
+
+    previous.close();
+  }
+
+  std::ostringstream stream;
+  for(const std::string &line : lines)
+    stream << line << '\n';
+  stream << toJSON(time) << '\n';
+
+  return FS::write(path, stream.str());
+}
@@ -0,0 +1,107 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2025  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_TELEMETRY_HPP
+#define REAPACK_TELEMETRY_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Path;
+
+// CURLINFO measures of a single transfer attempt
+struct TransferStats {
+  std::string host;
+
+  // seconds elapsed from the start of the transfer until each step completed
+  double nameLookup;
+  double connect;
+  double appConnect; // TLS handshake, 0 for plain HTTP
+  double startTransfer; // first byte received
+  double total;
+
+  int64_t size;
+  std::string httpVersion; // eg. "1.1" or "2", empty if no response
+  bool reused; // the connection was already open
+};
+
+class HostStats {
+public:
+  HostStats(const std::string &host);
+
+  void add(const TransferStats &);
+
+  const std::string &host() const { return m_host; }
+  unsigned int transfers() const { return m_transfers; }
+  unsigned int connections() const { return m_connections; }
+  int64_t bytes() const { return m_bytes; }
+
+  // average duration of each step in seconds, connection setup steps only
+  // account for the transfers that did not reuse a connection
+  double dns() const { return average(m_dns, m_connections); }
+  double connect() const { return average(m_connect, m_connections); }
+  double tls() const { return average(m_tls, m_connections); }
+  double firstByte() const { return average(m_firstByte, m_transfers); }
+  double download() const { return average(m_download, m_transfers); }
+  double total() const { return average(m_total, m_transfers); }
+  double slowest() const { return m_slowest; }
+  double speed() const; // bytes per second
+
+  std::string toJSON() const;
+
+private:
+  static double average(double sum, unsigned int count)
+  {
+    return count ? sum / count : 0;
+  }
+
+  std::string m_host;
+  unsigned int m_transfers;
+  unsigned int m_connections;
+  int64_t m_bytes;
+  double m_dns;
+  double m_connect;
+  double m_tls;
+  double m_firstByte;
+  double m_download;
+  double m_total;
+  double m_slowest;
+  std::map<std::string, unsigned int> m_httpVersions;
+};
+
+std::ostream &operator<<(std::ostream &, const HostStats &);
+
+class NetworkStats {
+public:
+  void add(const TransferStats &);
+
+  bool empty() const { return m_hosts.empty(); }
+  const std::vector<HostStats> &hosts() const { return m_hosts; }
+
+  std::string toJSON(time_t) const;
+  // appends a line to a JSON Lines file, keeping only the latest runs
+  bool save(const Path &, time_t) const;
+
+private:
+  std::vector<HostStats> m_hosts;
+};
+
+#endif
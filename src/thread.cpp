@@ -17,8 +17,12 @@
 
 #include "thread.hpp"
 
+#include "download.hpp"
+
 #include <reaper_plugin_functions.h>
 
+static const size_t WORKER_COUNT = 6;
+
 #ifdef _WIN32
   typedef void (__stdcall *_tls_callback_type)(HANDLE, DWORD const dwReason, LPVOID);
   extern "C" extern const _tls_callback_type __dyn_tls_dtor_callback;
@@ -34,20 +38,42 @@ ThreadTask::~ThreadTask()
 
 void ThreadTask::exec()
 {
-  State state = Idle;
+  finish(start() && run());
+}
 
-  if(!aborted()) {
-    onStartAsync();
-    state = run() ? Success : Failure;
-  }
+bool ThreadTask::start()
+{
+  if(aborted())
+    return false;
 
+  onStartAsync();
+  return true;
+}
+
+void ThreadTask::finish(const bool success)
+{
   if(aborted()) // may have changed while the task was running
-    state = Aborted;
+    m_state = Aborted;
+  else
+    m_state = success ? Success : Failure;
 
-  m_state = state;
   onFinishAsync();
 }
 
+static void releaseThreadStorage()
+{
+#ifdef _WIN32
+  // HACK: Destruct thread-local storage objects earlier on Windows to avoid a
+  // possible deadlock when tearing down the cURL context with active HTTPS
+  // connections on some computers [p=2038163]. InitializeSecurityContext would
+  // hang forever waiting for a semaphore for undetermined reasons...
+  //
+  // Note that the destructors are not called a second time when this function
+  // is invoked by the C++ runtime during the normal thread shutdown procedure.
+  __dyn_tls_dtor_callback(nullptr, DLL_THREAD_DETACH, nullptr);
+#endif
+}
+
 WorkerThread::WorkerThread() : m_stop(false), m_thread(&WorkerThread::run, this)
 {
 }
@@ -81,16 +107,7 @@ void WorkerThread::run()
     lock.lock();
   }
 
-#ifdef _WIN32
-  // HACK: Destruct thread-local storage objects earlier on Windows to avoid a
-  // possible deadlock when tearing down the cURL context with active HTTPS
-  // connections on some computers [p=2038163]. InitializeSecurityContext would
-  // hang forever waiting for a semaphore for undetermined reasons...
-  //
-  // Note that the destructors are not called a second time when this function
-  // is invoked by the C++ runtime during the normal thread shutdown procedure.
-  __dyn_tls_dtor_callback(nullptr, DLL_THREAD_DETACH, nullptr);
-#endif
+  releaseThreadStorage();
 }
 
 ThreadTask *WorkerThread::nextTask()
@@ -113,6 +130,99 @@ void WorkerThread::push(ThreadTask *task)
   m_wake.notify_one();
 }
 
+WorkerGroup::WorkerGroup(const size_t size)
+  : m_next(0), m_queued(0), m_stop(false)
+{
+  m_workers.reserve(size);
+  for(size_t i = 0; i < size; ++i)
+    m_workers.push_back(std::make_unique<Worker>());
+
+  // start the threads only once every deque they may steal from exists
+  for(size_t i = 0; i < size; ++i)
+    m_workers[i]->thread = std::thread(&WorkerGroup::run, this, i);
+}
+
+WorkerGroup::~WorkerGroup()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_wake.notify_all();
+
+  for(const auto &worker : m_workers)
+    worker->thread.join();
+}
+
+void WorkerGroup::push(ThreadTask *task)
+{
+  Worker &worker = *m_workers[m_next++ % m_workers.size()];
+
+  {
+    std::lock_guard lock(m_mutex);
+    ++m_queued;
+  }
+
+  {
+    std::lock_guard guard(worker.mutex);
+    worker.queue.push_back(task);
+  }
+
+  // any idle worker will do: it steals the task if it isn't its own
+  m_wake.notify_one();
+}
+
+void WorkerGroup::run(const size_t index)
+{
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [=] { return m_queued > 0 || m_stop; });
+
+      if(m_stop)
+        break;
+    }
+
+    if(ThreadTask *task = nextTask(index))
+      task->exec();
+  }
+
+  releaseThreadStorage();
+}
+
+ThreadTask *WorkerGroup::nextTask(const size_t index)
+{
+  ThreadTask *task = nullptr;
+
+  for(size_t i = 0; i < m_workers.size() && !task; ++i) {
+    Worker &worker = *m_workers[(index + i) % m_workers.size()];
+    std::lock_guard guard(worker.mutex);
+
+    if(worker.queue.empty())
+      continue;
+    else if(i == 0) { // own tasks are run in order
+      task = worker.queue.front();
+      worker.queue.pop_front();
+    }
+    else {
+      task = worker.queue.back();
+      worker.queue.pop_back();
+    }
+  }
+
+  if(task) {
+    std::lock_guard lock(m_mutex);
+    --m_queued;
+  }
+
+  return task;
+}
+
+ThreadPool::ThreadPool()
+{
+}
+
 ThreadPool::~ThreadPool()
 {
   // don't emit ThreadPool::onAbort from the destructor
@@ -139,12 +249,36 @@ void ThreadPool::push(ThreadTask *task)
       self->onDone();
   };
 
-  const size_t nextThread = m_running.size() % m_pool.size();
-  auto &thread = task->concurrent() ? m_pool[nextThread] : m_pool.front();
-  if(!thread)
-    thread = std::make_unique<WorkerThread>();
+  if(Download *dl = dynamic_cast<Download *>(task)) {
+    downloadThread()->push(dl);
+    return;
+  }
 
-  thread->push(task);
+  if(task->concurrent()) {
+    if(!m_workers)
+      m_workers = std::make_unique<WorkerGroup>(WORKER_COUNT);
+
+    m_workers->push(task);
+  }
+  else {
+    // run one at a time, alongside the concurrent tasks
+    if(!m_serial)
+      m_serial = std::make_unique<WorkerThread>();
+
+    m_serial->push(task);
+  }
+}
+
+DownloadThread *ThreadPool::downloadThread()
+{
+  if(!m_downloadThread) {
+    m_downloadThread = std::make_unique<DownloadThread>();
+    m_downloadThread->onProgress >> [this](int64_t received, int64_t expected) {
+      onDownloadProgress(received, expected);
+    };
+  }
+
+  return m_downloadThread.get();
 }
 
 void ThreadPool::abort()
@@ -152,5 +286,9 @@ void ThreadPool::abort()
   for(ThreadTask *task : m_running)
     task->abort();
 
+  // cancel the in-flight transfers now rather than on their next callback
+  if(m_downloadThread)
+    m_downloadThread->wakeUp();
+
   onAbort();
 }
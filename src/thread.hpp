@@ -20,13 +20,17 @@
 
 #include "errors.hpp"
 #include "event.hpp"
+#include "telemetry.hpp"
 
-#include <array>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <queue>
 #include <thread>
 #include <unordered_set>
+#include <vector>
+
+class DownloadThread;
 
 struct ThreadSummary {
   const char *step;
@@ -50,10 +54,13 @@ public:
   virtual bool concurrent() const = 0;
 
   void exec();  // runs in the current thread
+  bool start(); // emits onStartAsync unless aborted
+  void finish(bool success);
   const ThreadSummary &summary() const { return m_summary; }
   State state() const { return m_state; }
   void setError(const ErrorInfo &err) { m_error = err; }
   const ErrorInfo &error() { return m_error; }
+  const std::vector<TransferStats> &transfers() const { return m_transfers; }
 
   bool aborted() const { return m_abort; }
   void abort() { m_abort = true; }
@@ -65,11 +72,13 @@ protected:
   virtual bool run() = 0;
 
   void setSummary(const ThreadSummary &s) { m_summary = s; }
+  void addTransfer(const TransferStats &t) { m_transfers.push_back(t); }
 
 private:
   ThreadSummary m_summary;
   State m_state;
   ErrorInfo m_error;
+  std::vector<TransferStats> m_transfers;
   std::atomic_bool m_abort;
 };
 
@@ -93,9 +102,38 @@ private:
   std::thread m_thread;
 };
 
+// Runs the concurrent tasks of a ThreadPool. Each worker has its own deque and
+// idle workers steal from the back of the others' so a long task doesn't hold
+// back the ones that were queued after it.
+class WorkerGroup {
+public:
+  WorkerGroup(size_t size);
+  WorkerGroup(const WorkerGroup &) = delete;
+  ~WorkerGroup();
+
+  void push(ThreadTask *);
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<ThreadTask *> queue;
+    std::thread thread;
+  };
+
+  void run(size_t index);
+  ThreadTask *nextTask(size_t index);
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  size_t m_next;
+  size_t m_queued;
+  bool m_stop;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+};
+
 class ThreadPool {
 public:
-  ThreadPool() {}
+  ThreadPool();
   ThreadPool(const ThreadPool &) = delete;
   ~ThreadPool();
 
@@ -105,11 +143,17 @@ public:
   bool idle() const { return m_running.empty(); }
 
   Event<void(ThreadTask *)> onPush;
+  // bytes received and expected from all the downloads pushed so far
+  Event<void(int64_t received, int64_t expected)> onDownloadProgress;
   Event<void()> onAbort;
   Event<void()> onDone;
 
 private:
-  std::array<std::unique_ptr<WorkerThread>, 6> m_pool;
+  DownloadThread *downloadThread();
+
+  std::unique_ptr<WorkerGroup> m_workers;
+  std::unique_ptr<WorkerThread> m_serial; // for non-concurrent tasks
+  std::unique_ptr<DownloadThread> m_downloadThread;
   std::unordered_set<ThreadTask *> m_running;
 };
 
@@ -27,16 +27,25 @@
 #include "task.hpp"
 
 #include <cassert>
+#include <ctime>
 
 #include <reaper_plugin_functions.h>
 
+// interrupted downloads that could still be resumed later
+static constexpr time_t PARTIAL_MAX_AGE = 7 * 24 * 3600;
+static constexpr int64_t PARTIAL_MAX_SIZE = 256 * 1024 * 1024;
+
 Transaction::Transaction()
-  : m_isCancelled(false), m_registry(Path::REGISTRY.prependRoot())
+  : m_isCancelled(false), m_registry(Path::REGISTRY.prependRoot()),
+    m_store((Path::STORE + "index.db").prependRoot()), m_downloads(this)
 {
   m_threadPool.onPush >> [this] (ThreadTask *task) {
     task->onFinishAsync >> [=] {
       if(task->state() == ThreadTask::Failure)
         m_receipt.addError(task->error());
+
+      for(const TransferStats &stats : task->transfers())
+        m_receipt.addTransfer(stats);
     };
   };
 
@@ -82,22 +91,15 @@ std::vector<IndexPtr> Transaction::getIndexes(const std::vector<Remote> &remotes
   return indexes;
 }
 
-IndexPtr Transaction::loadIndex(const Remote &remote)
+IndexPtr Transaction::index(const Remote &remote) const
 {
   const auto &it = m_indexes.find(remote.name());
-  if(it != m_indexes.end())
-    return it->second;
+  return it != m_indexes.end() ? it->second : nullptr;
+}
 
-  try {
-    const IndexPtr &ri = Index::load(remote.name());
-    m_indexes[remote.name()] = ri;
-    return ri;
-  }
-  catch(const reapack_error &e) {
-    m_receipt.addError({
-      String::format("Could not load repository: %s", e.what()), remote.name()});
-    return nullptr;
-  }
+void Transaction::setIndex(const Remote &remote, const IndexPtr &index)
+{
+  m_indexes[remote.name()] = index;
 }
 
 void Transaction::install(const Version *ver, const int flags,
@@ -128,6 +130,9 @@ void Transaction::uninstall(const Remote &remote)
       m_receipt.addError({FS::lastError(), indexPath.join()});
   }
 
+  FS::remove(Index::validatorsPathFor(remote.name()));
+  FS::remove(Index::snapshotPathFor(remote.name()));
+
   for(const auto &entry : m_registry.getEntries(remote.name()))
     uninstall(entry);
 }
@@ -210,9 +215,16 @@ bool Transaction::commitTasks()
 
 void Transaction::finish()
 {
+  m_store.trim(static_cast<int64_t>(
+    g_reapack->config()->install.storeSize) * 1024 * 1024);
+  m_store.commit();
+  FileDownload::trimPartials(PARTIAL_MAX_AGE, PARTIAL_MAX_SIZE);
   m_registry.commit();
   registerQueued();
 
+  if(!m_receipt.network().empty())
+    m_receipt.network().save(Path::TELEMETRY, time(nullptr));
+
   onFinish();
   m_cleanupHandler();
 }
@@ -18,9 +18,11 @@
 #ifndef REAPACK_TRANSACTION_HPP
 #define REAPACK_TRANSACTION_HPP
 
+#include "broker.hpp"
 #include "event.hpp"
 #include "receipt.hpp"
 #include "registry.hpp"
+#include "store.hpp"
 #include "task.hpp"
 #include "thread.hpp"
 
@@ -68,7 +70,9 @@ public:
 
   Receipt *receipt() { return &m_receipt; }
   Registry *registry() { return &m_registry; }
+  Store *store() { return &m_store; }
   ThreadPool *threadPool() { return &m_threadPool; }
+  DownloadBroker *downloads() { return &m_downloads; }
 
   Event<void()> onFinish;
 
@@ -77,7 +81,8 @@ protected:
   friend InstallTask;
   friend UninstallTask;
 
-  IndexPtr loadIndex(const Remote &);
+  IndexPtr index(const Remote &) const;
+  void setIndex(const Remote &, const IndexPtr &);
   void addObsolete(const Registry::Entry &e) { m_obsolete.insert(e); }
   void registerAll(bool add, const Registry::Entry &);
   void registerFile(const HostTicket &);
@@ -104,6 +109,7 @@ private:
 
   bool m_isCancelled;
   Registry m_registry;
+  Store m_store;
   Receipt m_receipt;
 
   std::unordered_set<std::string> m_syncedRemotes;
@@ -111,6 +117,7 @@ private:
   std::unordered_set<Registry::Entry> m_obsolete;
 
   ThreadPool m_threadPool;
+  DownloadBroker m_downloads;
   TaskQueue m_nextQueue;
   std::queue<TaskQueue> m_taskQueues;
   std::queue<TaskPtr> m_runningTasks;
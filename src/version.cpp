@@ -21,9 +21,8 @@
 #include "package.hpp"
 #include "source.hpp"
 
-#include <boost/lexical_cast.hpp>
-#include <cctype>
-#include <regex>
+#include <algorithm>
+#include <limits>
 
 std::string Version::displayAuthor(const std::string &author)
 {
@@ -89,7 +88,7 @@ std::ostream &operator<<(std::ostream &os, const Version &ver)
   return os;
 }
 
-VersionName::VersionName() : m_stable(true)
+VersionName::VersionName() : m_key(0), m_packed(true), m_stable(true)
 {}
 
 VersionName::VersionName(const std::string &str)
@@ -97,47 +96,67 @@ VersionName::VersionName(const std::string &str)
   parse(str);
 }
 
-VersionName::VersionName(const VersionName &o)
-  : m_string(o.m_string), m_segments(o.m_segments), m_stable(o.m_stable)
+static bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+static bool isLetter(const char c)
 {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
 void VersionName::parse(const std::string &str)
 {
-  static const std::regex pattern("\\d+|[a-zA-Z]+");
+  constexpr uint32_t NUMERIC_MAX = std::numeric_limits<Numeric>::max();
 
-  const auto &begin = std::sregex_iterator(str.begin(), str.end(), pattern);
-  const std::sregex_iterator end;
+  Segments segments;
 
-  size_t letters = 0;
-  std::vector<Segment> segments;
+  for(size_t i = 0, size = str.size(); i < size;) {
+    const size_t begin = i;
 
-  for(std::sregex_iterator it = begin; it != end; it++) {
-    const std::string &match = it->str(0);
+    if(isDigit(str[i])) {
+      uint32_t value = 0;
 
-    if(isalpha(match[0])) {
+      do {
+        value = value * 10 + (str[i] - '0');
+        if(value > NUMERIC_MAX)
+          throw reapack_error(String::format("version segment overflow in '%s'", str.c_str()));
+      } while(++i < size && isDigit(str[i]));
+
+      segments.push_back({static_cast<uint32_t>(begin), 0, static_cast<Numeric>(value)});
+    }
+    else if(isLetter(str[i])) {
       if(segments.empty()) // got leading letters
         throw reapack_error(String::format("invalid version name '%s'", str.c_str()));
 
-      segments.push_back(match);
-      letters++;
-    }
-    else {
-      try {
-        segments.push_back(boost::lexical_cast<Numeric>(match));
-      }
-      catch(const boost::bad_lexical_cast &) {
-        throw reapack_error(String::format("version segment overflow in '%s'", str.c_str()));
-      }
+      while(++i < size && isLetter(str[i]));
+
+      segments.push_back({static_cast<uint32_t>(begin), static_cast<uint32_t>(i - begin), 0});
     }
+    else
+      ++i; // separator
   }
 
   if(segments.empty()) // version doesn't have any numbers
     throw reapack_error(String::format("invalid version name '%s'", str.c_str()));
 
+  assign(str, std::move(segments));
+}
+
+void VersionName::assign(const std::string &str, Segments &&segments)
+{
   m_string = str;
-  swap(m_segments, segments);
-  m_stable = letters < 1;
+  m_segments = std::move(segments);
+  m_stable = std::none_of(m_segments.begin(), m_segments.end(),
+    [](const Segment &seg) { return seg.letters > 0; });
+
+  m_packed = m_stable && m_segments.size() <= PACKED_SEGMENTS;
+  m_key = 0;
+
+  if(m_packed) {
+    for(size_t i = 0; i < PACKED_SEGMENTS; ++i) {
+      m_key <<= sizeof(Numeric) * 8;
+      if(i < m_segments.size())
+        m_key |= m_segments[i].value;
+    }
+  }
 }
 
 bool VersionName::tryParse(const std::string &str, std::string *errorOut)
@@ -154,18 +173,100 @@ bool VersionName::tryParse(const std::string &str, std::string *errorOut)
   }
 }
 
+// three little-endian 16-bit fields per segment: offset, letters and value
+static constexpr size_t SEGMENT_DATA_SIZE = 6;
+
+std::string VersionName::segmentData() const
+{
+  std::string data;
+
+  if(m_string.size() > std::numeric_limits<uint16_t>::max())
+    return data;
+
+  data.reserve(m_segments.size() * SEGMENT_DATA_SIZE);
+
+  for(const Segment &seg : m_segments) {
+    for(const uint32_t field : {seg.offset, seg.letters, uint32_t{seg.value}}) {
+      data += static_cast<char>(field & 0xff);
+      data += static_cast<char>(field >> 8);
+    }
+  }
+
+  return data;
+}
+
+bool VersionName::restore(const std::string &str, const std::string &data)
+{
+  if(data.empty() || data.size() % SEGMENT_DATA_SIZE)
+    return false;
+
+  const auto field = [&](const size_t pos) -> uint32_t {
+    return static_cast<uint8_t>(data[pos]) | static_cast<uint8_t>(data[pos + 1]) << 8;
+  };
+
+  // the string must tokenize exactly into the stored segments: stale data
+  // (eg. from an older version of the same entry) falls back to parsing
+  const auto isSeparators = [&](size_t begin, const size_t end) {
+    for(; begin < end; ++begin) {
+      if(isDigit(str[begin]) || isLetter(str[begin]))
+        return false;
+    }
+    return true;
+  };
+
+  Segments segments;
+  size_t end = 0;
+
+  for(size_t pos = 0; pos < data.size(); pos += SEGMENT_DATA_SIZE) {
+    const Segment seg{field(pos), field(pos + 2), static_cast<Numeric>(field(pos + 4))};
+
+    if(seg.offset < end || seg.offset >= str.size() || !isSeparators(end, seg.offset))
+      return false;
+
+    size_t i = seg.offset;
+
+    if(seg.letters) {
+      if(segments.empty()) // leading letters are never valid
+        return false;
+
+      while(i < str.size() && isLetter(str[i]))
+        ++i;
+
+      if(i - seg.offset != seg.letters)
+        return false;
+    }
+    else {
+      uint32_t value = 0;
+
+      while(i < str.size() && isDigit(str[i]) && value <= seg.value)
+        value = value * 10 + (str[i++] - '0');
+
+      if(i == seg.offset || value != seg.value ||
+          (i < str.size() && isDigit(str[i])))
+        return false;
+    }
+
+    end = i;
+    segments.push_back(seg);
+  }
+
+  if(!isSeparators(end, str.size()))
+    return false;
+
+  assign(str, std::move(segments));
+  return true;
+}
+
 auto VersionName::segment(const size_t index) const -> Segment
 {
   if(index < size())
     return m_segments[index];
   else
-    return {};
+    return {}; // missing segments count as zeros
 }
 
 int VersionName::compare(const VersionName &o) const
 {
-  const size_t biggest = std::max(size(), o.size());
-
   switch(m_segments.empty() + o.m_segments.empty()) {
   case 1:
     return m_segments.empty() ? -1 : 1;
@@ -173,31 +274,81 @@ int VersionName::compare(const VersionName &o) const
     return 0;
   }
 
+  if(m_packed && o.m_packed)
+    return (m_key > o.m_key) - (m_key < o.m_key);
+
+  return compareSegments(o);
+}
+
+std::string VersionName::sortKey() const
+{
+  // Ordered tags. A zero compares against the end of a shorter version (an
+  // endless run of zeros) depending on what follows it, so the trailing
+  // zeros are omitted and each other zero is tagged with what comes next.
+  enum Tag : char {
+    Letters = 1,
+    ZeroBeforeLetters,
+    End,
+    ZeroBeforeNumber,
+    Number,
+  };
+
+  std::string key;
+
+  if(m_segments.empty())
+    return key; // before any valid version
+
+  size_t last = m_segments.size();
+  while(last > 0 && !m_segments[last - 1].letters && !m_segments[last - 1].value)
+    --last;
+
+  for(size_t i = 0; i < last; ++i) {
+    const Segment &seg = m_segments[i];
+
+    if(seg.letters) {
+      key += Letters;
+      key.append(m_string, seg.offset, seg.letters);
+      key += '\0';
+    }
+    else if(seg.value) {
+      key += Number;
+      key += static_cast<char>(seg.value >> 8);
+      key += static_cast<char>(seg.value & 0xff);
+    }
+    else {
+      size_t next = i + 1;
+      while(!m_segments[next].letters && !m_segments[next].value)
+        ++next; // there is a non-zero segment before 'last'
+
+      key += m_segments[next].letters ? ZeroBeforeLetters : ZeroBeforeNumber;
+    }
+  }
+
+  key += End;
+
+  return key;
+}
+
+int VersionName::compareSegments(const VersionName &o) const
+{
+  const size_t biggest = std::max(size(), o.size());
+
   for(size_t i = 0; i < biggest; i++) {
-    const Segment &lseg = segment(i);
-    const Numeric *lnum = std::get_if<Numeric>(&lseg);
-    const std::string *lstr = std::get_if<std::string>(&lseg);
-
-    const Segment &rseg = o.segment(i);
-    const Numeric *rnum = std::get_if<Numeric>(&rseg);
-    const std::string *rstr = std::get_if<std::string>(&rseg);
-
-    if(lnum && rnum) {
-      if(*lnum < *rnum)
-        return -1;
-      else if(*lnum > *rnum)
-        return 1;
+    const Segment &lseg = segment(i), &rseg = o.segment(i);
+
+    if(!lseg.letters && !rseg.letters) {
+      if(lseg.value != rseg.value)
+        return lseg.value < rseg.value ? -1 : 1;
     }
-    else if(lstr && rstr) {
-      if(*lstr < *rstr)
-        return -1;
-      else if(*lstr > *rstr)
-        return 1;
+    else if(lseg.letters && rseg.letters) {
+      const int diff = m_string.compare(lseg.offset, lseg.letters,
+        o.m_string, rseg.offset, rseg.letters);
+
+      if(diff)
+        return diff < 0 ? -1 : 1;
     }
-    else if(lnum && rstr)
-      return 1;
-    else if(lstr && rnum)
-      return -1;
+    else // numbers are greater than letters
+      return lseg.letters ? -1 : 1;
   }
 
   return 0;
@@ -18,12 +18,14 @@
 #ifndef REAPACK_VERSION_HPP
 #define REAPACK_VERSION_HPP
 
+#include "intern.hpp"
+#include "lazytext.hpp"
 #include "time.hpp"
 
+#include <boost/container/small_vector.hpp>
 #include <cstdint>
 #include <map>
 #include <set>
-#include <variant>
 #include <vector>
 
 class Package;
@@ -34,9 +36,6 @@ class VersionName {
 public:
   VersionName();
   VersionName(const std::string &);
-  VersionName(const VersionName &);
-
-  VersionName &operator=(const VersionName &) = default;
 
   void parse(const std::string &);
   bool tryParse(const std::string &, std::string *errorOut = nullptr);
@@ -47,6 +46,14 @@ public:
 
   int compare(const VersionName &) const;
 
+  // binary string ordered by memcmp (or SQLite) the same way as compare()
+  std::string sortKey() const;
+
+  // segments of the parsed version in binary form, from which restore()
+  // rebuilds it without parsing the string again (empty if unsupported)
+  std::string segmentData() const;
+  bool restore(const std::string &, const std::string &segmentData);
+
 #define COMPOP(op) \
   bool operator op (const VersionName &o) const { return compare(o) op 0; }
 
@@ -56,12 +63,27 @@ public:
 
 private:
   typedef uint16_t Numeric;
-  typedef std::variant<Numeric, std::string> Segment;
 
+  // a number or a run of letters from m_string
+  struct Segment {
+    uint32_t offset;
+    uint32_t letters; // 0 for numbers
+    Numeric value;
+  };
+
+  // versions made of up to this many numbers have a packed key
+  static constexpr size_t PACKED_SEGMENTS = 64 / (sizeof(Numeric) * 8);
+
+  typedef boost::container::small_vector<Segment, PACKED_SEGMENTS> Segments;
+
+  void assign(const std::string &, Segments &&);
   Segment segment(size_t i) const;
+  int compareSegments(const VersionName &) const;
 
   std::string m_string;
-  std::vector<Segment> m_segments;
+  Segments m_segments;
+  uint64_t m_key; // all numbers side by side, most significant first
+  bool m_packed;
   bool m_stable;
 };
 
@@ -84,7 +106,8 @@ public:
   const Time &time() const { return m_time; }
 
   void setChangelog(const std::string &cl) { m_changelog = cl; }
-  const std::string &changelog() const { return m_changelog; }
+  void setChangelog(const LazyText &cl) { m_changelog = cl; }
+  const std::string &changelog() const { return m_changelog.get(); }
 
   bool addSource(const Source *source);
   const auto &sources() const { return m_sources; }
@@ -94,8 +117,8 @@ public:
 
 private:
   VersionName m_name;
-  std::string m_author;
-  std::string m_changelog;
+  InternedString m_author;
+  LazyText m_changelog;
   Time m_time;
   const Package *m_package;
   std::vector<const Source *> m_sources;
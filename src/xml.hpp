@@ -18,13 +18,16 @@
 #ifndef REAPACK_XML_HPP
 #define REAPACK_XML_HPP
 
+#include <cstddef>
 #include <istream>
 #include <memory>
 
 class XmlNode;
+class XmlParser;
 class XmlString;
 
 class XmlDocument {
+  friend XmlParser;
   struct Impl;
   using ImplPtr = std::unique_ptr<Impl>;
 
@@ -39,6 +42,25 @@ public:
 
   XmlNode root() const;
 
+private:
+  XmlDocument(ImplPtr &&);
+
+  ImplPtr m_impl;
+};
+
+// builds a document from the chunks of data as they are received
+class XmlParser {
+  struct Impl;
+  using ImplPtr = std::unique_ptr<Impl>;
+
+public:
+  XmlParser();
+  XmlParser(const XmlParser &) = delete;
+  ~XmlParser();
+
+  void write(const char *data, size_t len);
+  XmlDocument finish();
+
 private:
   ImplPtr m_impl;
 };
@@ -17,16 +17,34 @@
 
 #include "xml.hpp"
 
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstring>
+#include <string>
 
 #include <libxml/parser.h>
 
 constexpr int LIBXML2_OPTIONS =
   XML_PARSE_NOBLANKS | XML_PARSE_NOERROR | XML_PARSE_NOWARNING;
 
-struct XmlDocument::Impl { xmlDoc *doc;   };
+struct XmlDocument::Impl { xmlDoc *doc; std::string error; };
 struct XmlNode::Impl     { xmlNode *node; };
+struct XmlParser::Impl   { xmlParserCtxt *ctxt; };
+
+static std::string errorMessage(const xmlError *error)
+{
+  if(!error || !error->message)
+    return "malformed XML document";
+
+  std::string message = error->message;
+
+  // remove trailing newline
+  if(message.size() > 1 && message.back() == '\n')
+    message.pop_back();
+
+  return message;
+}
 
 static int readCallback(void *context, char *buffer, const int size)
 {
@@ -42,8 +60,12 @@ XmlDocument::XmlDocument(std::istream &stream) : m_impl{new Impl}
   m_impl->doc =
     xmlReadIO(&readCallback, nullptr, static_cast<void *>(&stream),
       nullptr, nullptr, LIBXML2_OPTIONS);
+
+  if(!m_impl->doc || xmlGetLastError())
+    m_impl->error = errorMessage(xmlGetLastError());
 }
 
+XmlDocument::XmlDocument(ImplPtr &&impl) : m_impl{std::move(impl)} {}
 XmlDocument::XmlDocument(XmlDocument &&) = default;
 
 XmlDocument::~XmlDocument()
@@ -54,24 +76,12 @@ XmlDocument::~XmlDocument()
 
 XmlDocument::operator bool() const
 {
-  return m_impl->doc && xmlGetLastError() == nullptr;
+  return m_impl->doc && m_impl->error.empty();
 }
 
 const char *XmlDocument::error() const
 {
-  if(const xmlError *error = xmlGetLastError()) {
-    const size_t length = strlen(error->message);
-    if(length > 1) {
-      // remove trailing newline
-      char &tail = error->message[length - 1];
-      if(tail == '\n')
-        tail = 0;
-    }
-
-    return error->message;
-  }
-
-  return nullptr;
+  return m_impl->error.empty() ? nullptr : m_impl->error.c_str();
 }
 
 XmlNode XmlDocument::root() const
@@ -142,3 +152,47 @@ XmlNode XmlNode::nextSibling(const char *element) const
 
 XmlString::XmlString(const void *str) : m_str(str) {}
 XmlString::~XmlString() { xmlFree(const_cast<void *>(m_str)); }
+
+XmlParser::XmlParser()
+  : m_impl{new Impl{xmlCreatePushParserCtxt(nullptr, nullptr, nullptr, 0, nullptr)}}
+{
+  xmlCtxtUseOptions(m_impl->ctxt, LIBXML2_OPTIONS);
+}
+
+XmlParser::~XmlParser()
+{
+  if(m_impl->ctxt) {
+    if(m_impl->ctxt->myDoc)
+      xmlFreeDoc(m_impl->ctxt->myDoc);
+    xmlFreeParserCtxt(m_impl->ctxt);
+  }
+}
+
+void XmlParser::write(const char *data, size_t len)
+{
+  while(len > 0) {
+    const int chunk = static_cast<int>(std::min<size_t>(len, INT_MAX));
+    xmlParseChunk(m_impl->ctxt, data, chunk, 0);
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+XmlDocument XmlParser::finish()
+{
+  xmlParserCtxt *ctxt = m_impl->ctxt;
+  xmlParseChunk(ctxt, nullptr, 0, 1);
+
+  // errors are read from the context rather than the global state as
+  // several documents may be parsed in the same thread at once
+  auto doc = std::make_unique<XmlDocument::Impl>();
+  doc->doc = ctxt->myDoc;
+  ctxt->myDoc = nullptr;
+  if(!doc->doc || !ctxt->wellFormed)
+    doc->error = errorMessage(xmlCtxtGetLastError(ctxt));
+
+  xmlFreeParserCtxt(ctxt);
+  m_impl->ctxt = nullptr;
+
+  return XmlDocument{std::move(doc)};
+}
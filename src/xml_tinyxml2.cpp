@@ -18,11 +18,13 @@
 #include "xml.hpp"
 
 #include <iterator>
+#include <string>
 
 #include <tinyxml2.h>
 
 struct XmlDocument::Impl { tinyxml2::XMLDocument doc;  };
 struct XmlNode::Impl     { tinyxml2::XMLElement *node; };
+struct XmlParser::Impl   { std::string buffer; };
 
 XmlDocument::XmlDocument(std::istream &stream)
   : m_impl{std::make_unique<Impl>()}
@@ -31,6 +33,7 @@ XmlDocument::XmlDocument(std::istream &stream)
   m_impl->doc.Parse(everything.c_str(), everything.size());
 }
 
+XmlDocument::XmlDocument(ImplPtr &&impl) : m_impl{std::move(impl)} {}
 XmlDocument::XmlDocument(XmlDocument &&) = default;
 XmlDocument::~XmlDocument() = default;
 
@@ -98,3 +101,21 @@ XmlNode XmlNode::nextSibling(const char *element) const
 
 XmlString::XmlString(const void *str) : m_str(str) {}
 XmlString::~XmlString() = default;
+
+// tinyxml2 cannot parse incrementally: buffer the data until the end
+XmlParser::XmlParser() : m_impl{std::make_unique<Impl>()} {}
+XmlParser::~XmlParser() = default;
+
+void XmlParser::write(const char *data, const size_t len)
+{
+  m_impl->buffer.append(data, len);
+}
+
+XmlDocument XmlParser::finish()
+{
+  auto doc = std::make_unique<XmlDocument::Impl>();
+  doc->doc.Parse(m_impl->buffer.c_str(), m_impl->buffer.size());
+  m_impl->buffer.clear();
+
+  return XmlDocument{std::move(doc)};
+}
@@ -0,0 +1,22 @@
+#include "helper.hpp"
+
+#include <config.hpp>
+
+static const char *M = "[config]";
+
+TEST_CASE("parse per-host connection limits", M) {
+  NetworkOpts opts{};
+  opts.parseHostConnections("GitHub.com=2 example.org=8 invalid cdn.test=x");
+
+  const std::map<std::string, unsigned int> expected{
+    {"example.org", 8},
+    {"github.com", 2},
+  };
+
+  REQUIRE(opts.hostConnections == expected);
+  REQUIRE(opts.formatHostConnections() == "example.org=8 github.com=2");
+
+  opts.parseHostConnections({});
+  REQUIRE(opts.hostConnections.empty());
+  REQUIRE(opts.formatHostConnections().empty());
+}
@@ -24,6 +24,20 @@ TEST_CASE("file modification time", M) {
   REQUIRE(time > 0);
 }
 
+TEST_CASE("touch file", M) {
+  UseRootPath root(RIPATH);
+  const Path &path = Index::pathFor("Новая папка");
+
+  const time_t before = time(nullptr);
+  REQUIRE(FS::touch(path));
+
+  time_t after = 0;
+  REQUIRE(FS::mtime(path, &after));
+  REQUIRE(after >= before);
+
+  REQUIRE_FALSE(FS::touch(Index::pathFor("not_found")));
+}
+
 TEST_CASE("file exists", M) {
   UseRootPath root(RIPATH);
 
@@ -57,3 +71,23 @@ TEST_CASE("all files exists", M) {
   REQUIRE_FALSE(FS::allExists(std::vector<std::string>{"ReaPack"})); // directory
   REQUIRE(FS::allExists(std::vector<std::string>{"ReaPack"}, true));
 }
+
+TEST_CASE("list files in directory", M) {
+  UseRootPath root(RIPATH);
+
+  const Path dir("list_test");
+  REQUIRE(FS::mkdir(dir + "subdir"));
+  REQUIRE(FS::write(dir + "a.txt", "a"));
+  REQUIRE(FS::write(dir + "b.txt", "b"));
+
+  std::vector<std::string> files = FS::list(dir);
+  std::sort(files.begin(), files.end());
+  REQUIRE(files == std::vector<std::string>{"a.txt", "b.txt"});
+
+  REQUIRE(FS::list(dir + "not_found").empty());
+
+  FS::remove(dir + "a.txt");
+  FS::remove(dir + "b.txt");
+  FS::remove(dir + "subdir");
+  FS::remove(dir);
+}
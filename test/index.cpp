@@ -1,8 +1,11 @@
 #include "helper.hpp"
 
 #include <errors.hpp>
+#include <filesystem.hpp>
 #include <index.hpp>
 
+#include <chrono>
+
 static const char *M = "[index]";
 static const Path RIPATH("test/indexes");
 
@@ -230,3 +233,199 @@ TEST_CASE("find package", M) {
   REQUIRE(ri.find("cat", "b") == nullptr);
   REQUIRE(ri.find("cat", "pkg") == pack);
 }
+
+static const char *SNAPSHOT_TEST_INDEX = R"(<index version="1">
+  <category name="Category">
+    <reapack name="script.lua" type="script" desc="Description">
+      <version name="1.0" author="John Doe" time="2016-02-12T01:16:40Z">
+        <source main="main midi_editor" hash="1220ff" size="42">https://a.com/a.lua</source>
+        <source file="data.png" type="data">https://a.com/b.png</source>
+        <changelog>Changes</changelog>
+      </version>
+      <version name="1.1-beta"><source>https://a.com/c.lua</source></version>
+      <metadata><link rel="website" href="https://a.com">Website</link></metadata>
+    </reapack>
+  </category>
+  <metadata><description>About</description></metadata>
+</index>)";
+
+TEST_CASE("load index from snapshot", M) {
+  UseRootPath root(RIPATH);
+
+  const std::string name = "snapshot_test";
+  FS::remove(Index::snapshotPathFor(name));
+  REQUIRE(FS::write(Index::pathFor(name), SNAPSHOT_TEST_INDEX));
+
+  IndexPtr xml = Index::load(name);
+  REQUIRE(FS::exists(Index::snapshotPathFor(name)));
+
+  const Version *xmlVer = xml->packages()[0]->version(0);
+  const Time time = xmlVer->time();
+  const std::set<Path> files = xmlVer->files();
+  xml.reset(); // or it would be shared instead of loading the snapshot
+
+  SECTION("identical to the XML") {
+    const IndexPtr &ri = Index::load(name);
+    REQUIRE(ri->name() == name);
+    REQUIRE(ri->metadata()->about() == "About");
+    REQUIRE(ri->categories().size() == 1);
+    REQUIRE(ri->category(0)->name() == "Category");
+
+    const Package *pkg = ri->find("Category", "script.lua");
+    REQUIRE(pkg);
+    REQUIRE(pkg->type() == Package::ScriptType);
+    REQUIRE(pkg->description() == "Description");
+    REQUIRE(pkg->metadata()->links().size() == 1);
+    REQUIRE(pkg->metadata()->links().begin()->second.url == "https://a.com");
+    REQUIRE(pkg->versions().size() == 2);
+
+    const Version *ver = pkg->version(0);
+    REQUIRE(ver->name() == VersionName("1.0"));
+    REQUIRE(ver->author() == "John Doe");
+    REQUIRE(ver->time() == time);
+    REQUIRE(ver->changelog() == "Changes");
+    REQUIRE(ver->sources().size() == 2);
+    REQUIRE(ver->files() == files);
+
+    const Source *src = ver->source(0);
+    REQUIRE(src->file() == "script.lua");
+    REQUIRE(src->url() == "https://a.com/a.lua");
+    REQUIRE(src->checksum() == "1220ff");
+    REQUIRE(src->size() == 42);
+    REQUIRE(src->platform() == Platform::Generic);
+    REQUIRE(src->sections() == (Source::MainSection | Source::MIDIEditorSection));
+    REQUIRE(ver->source(1)->typeOverride() == Package::DataType);
+
+    REQUIRE_FALSE(pkg->version(1)->name().isStable());
+    REQUIRE_FALSE(pkg->version(1)->time());
+  }
+
+  SECTION("corrupted snapshot") {
+    REQUIRE(FS::write(Index::snapshotPathFor(name), "garbage"));
+
+    const IndexPtr &ri = Index::load(name);
+    REQUIRE(ri->packages().size() == 1);
+
+    // replaced by a valid snapshot
+    FS::MappedFile snapshot(Index::snapshotPathFor(name));
+    REQUIRE(snapshot.size() > 7);
+  }
+
+  SECTION("outdated snapshot") {
+    REQUIRE(FS::write(Index::pathFor(name), R"(<index version="1"/>)"));
+
+    const IndexPtr &ri = Index::load(name);
+    REQUIRE(ri->packages().empty());
+  }
+
+  FS::remove(Index::pathFor(name));
+  FS::remove(Index::snapshotPathFor(name));
+}
+
+TEST_CASE("share loaded indexes", M) {
+  UseRootPath root(RIPATH);
+
+  const std::string name = "cache_test";
+  REQUIRE(FS::write(Index::pathFor(name), SNAPSHOT_TEST_INDEX));
+
+  IndexPtr ri = Index::load(name);
+  REQUIRE(Index::load(name) == ri);
+
+  SECTION("modified file") {
+    REQUIRE(FS::write(Index::pathFor(name), R"(<index version="1"/>)"));
+    REQUIRE(Index::load(name) != ri);
+  }
+
+  SECTION("no longer in use") {
+    const std::weak_ptr<const Index> weak = ri;
+    ri.reset();
+    REQUIRE(weak.expired());
+    REQUIRE(Index::load(name)->packages().size() == 1);
+  }
+
+  FS::remove(Index::pathFor(name));
+  FS::remove(Index::snapshotPathFor(name));
+}
+
+TEST_CASE("read long texts from the snapshot on demand", M) {
+  UseRootPath root(RIPATH);
+
+  const std::string name = "snapshot_lazy_test", changelog(100, 'c');
+  FS::remove(Index::snapshotPathFor(name));
+  REQUIRE(FS::write(Index::pathFor(name),
+    R"(<index version="1"><category name="Category">)"
+    R"(<reapack name="script.lua" type="script"><version name="1.0">)"
+    R"(<source>https://a.com/a.lua</source><changelog>)" + changelog +
+    R"(</changelog></version></reapack></category></index>)"));
+
+  Index::load(name); // creates the snapshot
+  const IndexPtr &ri = Index::load(name);
+  const Version *ver = ri->packages()[0]->version(0);
+
+  // the texts must not have been read before the snapshot is modified
+  SECTION("snapshot replaced") {
+    const TempPath replacement(Index::snapshotPathFor(name));
+    REQUIRE(FS::write(replacement.temp(), "garbage"));
+    REQUIRE(FS::rename(replacement));
+    REQUIRE(ver->changelog() == changelog);
+  }
+
+  SECTION("snapshot removed") {
+    REQUIRE(FS::remove(Index::snapshotPathFor(name)));
+    REQUIRE(ver->changelog() == changelog);
+  }
+
+  SECTION("read only once") {
+    REQUIRE(ver->changelog() == changelog);
+    REQUIRE(&ver->changelog() == &ver->changelog());
+  }
+
+  FS::remove(Index::pathFor(name));
+  FS::remove(Index::snapshotPathFor(name));
+}
+
+TEST_CASE("index snapshot load time", "[index][.benchmark]") {
+  using namespace std::chrono;
+
+  UseRootPath root(RIPATH);
+
+  const std::string name = "snapshot_benchmark";
+
+  std::string xml = R"(<index version="1">)";
+  for(int c = 0; c < 20; ++c) {
+    xml += "<category name=\"Category " + std::to_string(c) + "\">";
+    for(int p = 0; p < 500; ++p) {
+      xml += "<reapack name=\"Package " + std::to_string(p) + ".lua\" type=\"script\">";
+      for(int v = 0; v < 4; ++v) {
+        xml += "<version name=\"1." + std::to_string(v) + "\" author=\"John Doe\""
+          " time=\"2016-02-12T01:16:40Z\"><changelog>Changes</changelog>"
+          "<source main=\"main\">https://example.com/" + std::to_string(c) + "/"
+          + std::to_string(p) + "/" + std::to_string(v) + ".lua</source></version>";
+      }
+      xml += "</reapack>";
+    }
+    xml += "</category>";
+  }
+  xml += "</index>";
+
+  REQUIRE(FS::write(Index::pathFor(name), xml));
+  FS::remove(Index::snapshotPathFor(name));
+
+  const auto measure = [&] {
+    const auto start = steady_clock::now();
+    const IndexPtr &ri = Index::load(name);
+    REQUIRE(ri->packages().size() == 10000);
+    return duration_cast<milliseconds>(steady_clock::now() - start);
+  };
+
+  const milliseconds cold = measure(), warm = measure();
+
+  WARN(xml.size() / 1024 << " KB index: " << cold.count()
+    << " ms from XML (including the snapshot), "
+    << warm.count() << " ms from the snapshot");
+
+  FS::remove(Index::pathFor(name));
+  FS::remove(Index::snapshotPathFor(name));
+
+  REQUIRE(warm < cold);
+}
@@ -319,3 +319,24 @@ TEST_CASE("read sha256 checksum", M) {
   REQUIRE(ri->category(0)->package(0)->version(0)->source(0)->checksum()
     == "12206037d8b51b33934348a2b26e04f0eb7227315b87bb5688ceb6dccb0468b14cce");
 }
+
+TEST_CASE("read source size", M) {
+  IndexPtr ri = Index::load({}, R"(
+<index version="1">
+  <category name="catname">
+    <reapack name="packname" type="script">
+      <version name="1.0" author="John Doe">
+        <source size="1048576">https://google.com/a</source>
+        <source file="b">https://google.com/b</source>
+        <source file="c" size="garbage">https://google.com/c</source>
+      </version>
+    </reapack>
+  </category>
+</index>
+  )");
+
+  const Version *ver = ri->category(0)->package(0)->version(0);
+  REQUIRE(ver->source(0)->size() == 1048576);
+  REQUIRE(ver->source(1)->size() == 0);
+  REQUIRE(ver->source(2)->size() == 0);
+}
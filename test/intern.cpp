@@ -0,0 +1,124 @@
+#include "helper.hpp"
+
+#include <filesystem.hpp>
+#include <index.hpp>
+#include <intern.hpp>
+
+static const char *M = "[intern]";
+
+TEST_CASE("interned strings share storage", M) {
+  const std::string text = "a string longer than the inline buffer";
+  const InternedString a(text), b(text.c_str());
+
+  REQUIRE(a == b);
+  REQUIRE(&a.str() == &b.str());
+  REQUIRE(&a.str() != &text);
+  REQUIRE(a == text);
+  REQUIRE(a.str() == text);
+}
+
+TEST_CASE("compare interned strings", M) {
+  const InternedString a("hello"), b("world");
+
+  REQUIRE(a != b);
+  REQUIRE(a < b);
+  REQUIRE_FALSE(b < a);
+  REQUIRE(a == "hello");
+  REQUIRE(a != "world");
+  REQUIRE(a == std::string("hello"));
+}
+
+TEST_CASE("empty interned string", M) {
+  const InternedString a, b(""), c(std::string{});
+
+  REQUIRE(a.empty());
+  REQUIRE(a.size() == 0);
+  REQUIRE(a == b);
+  REQUIRE(b == c);
+  REQUIRE(a == "");
+  REQUIRE(*a.c_str() == '\0');
+}
+
+TEST_CASE("interned string statistics", M) {
+  const std::string text = "statistics test string longer than the inline buffer";
+
+  const InternedString first(text);
+  const InternedString::Stats before = InternedString::stats();
+  const InternedString second(text);
+  const InternedString::Stats after = InternedString::stats();
+
+  REQUIRE(after.strings == before.strings);
+  REQUIRE(after.bytes == before.bytes);
+  REQUIRE(after.references == before.references + 1);
+  REQUIRE(after.savedBytes == before.savedBytes + text.size() + 1);
+}
+
+TEST_CASE("release interned strings", M) {
+  const std::string text = "a string that is only referenced by this test";
+  const size_t before = InternedString::stats().strings;
+
+  {
+    const InternedString a(text);
+    InternedString b(a), c;
+    c = b;
+    REQUIRE(InternedString::stats().strings == before + 1);
+
+    b = InternedString();
+    REQUIRE(InternedString::stats().strings == before + 1);
+    REQUIRE(c == a);
+  }
+
+  REQUIRE(InternedString::stats().strings == before);
+
+  const InternedString again(text);
+  REQUIRE(again == text);
+  REQUIRE(InternedString::stats().strings == before + 1);
+}
+
+TEST_CASE("index memory saved by interning", "[intern][.benchmark]") {
+  UseRootPath root(Path("test/indexes"));
+
+  const std::string name = "intern_benchmark";
+
+  // shaped like the ReaTeam repositories: few categories and authors,
+  // one commit per version with a few files each
+  std::string xml = R"(<index version="1">)";
+  for(int c = 0; c < 25; ++c) {
+    const std::string cat = "Category " + std::to_string(c);
+    xml += "<category name=\"" + cat + "\">";
+    for(int p = 0; p < 200; ++p) {
+      xml += "<reapack name=\"Package " + std::to_string(p) + ".lua\" type=\"script\">";
+      for(int v = 0; v < 5; ++v) {
+        const std::string commit = std::string(32, 'a' + (c + p + v) % 26) +
+          std::to_string(1000000 + c * 1000 + p * 5 + v);
+        xml += "<version name=\"1." + std::to_string(v) + "\" author=\"Author "
+          + std::to_string((c * 7 + p) % 150) + "\">";
+        for(int s = 0; s < 1 + p % 3; ++s) {
+          xml += "<source main=\"main\">https://github.com/ReaTeam/ReaScripts/raw/"
+            + commit + "/" + cat + "/Package " + std::to_string(p) + "_"
+            + std::to_string(s) + ".lua</source>";
+        }
+        xml += "</version>";
+      }
+      xml += "</reapack>";
+    }
+    xml += "</category>";
+  }
+  xml += "</index>";
+
+  REQUIRE(FS::write(Index::pathFor(name), xml));
+  FS::remove(Index::snapshotPathFor(name));
+
+  const InternedString::Stats before = InternedString::stats();
+  const IndexPtr ri = Index::load(name);
+  const InternedString::Stats after = InternedString::stats();
+
+  WARN(ri->packages().size() << " packages: "
+    << after.strings - before.strings << " distinct strings ("
+    << (after.bytes - before.bytes) / 1024 << " KB) shared by "
+    << after.references - before.references << " other references, "
+    << (after.savedBytes - before.savedBytes) / 1024 << " KB of copies saved");
+
+  FS::remove(Index::pathFor(name));
+  FS::remove(Index::snapshotPathFor(name));
+}
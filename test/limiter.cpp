@@ -0,0 +1,103 @@
+#include "helper.hpp"
+
+#include <config.hpp>
+#include <limiter.hpp>
+
+static const char *M = "[limiter]";
+
+static void fill(ConnectionLimiter &limiter, const std::string &host)
+{
+  while(limiter.available(host))
+    limiter.acquire(host);
+}
+
+TEST_CASE("initial connection window", M) {
+  ConnectionLimiter limiter;
+  fill(limiter, "a.com");
+  REQUIRE(limiter.active() == 6);
+  REQUIRE(limiter.available("b.com"));
+}
+
+TEST_CASE("total connection limit", M) {
+  ConnectionLimiter limiter;
+  limiter.setTotal(8);
+
+  fill(limiter, "a.com");
+  fill(limiter, "b.com");
+  REQUIRE(limiter.active() == 8);
+  REQUIRE_FALSE(limiter.available("c.com"));
+
+  limiter.release("a.com");
+  REQUIRE(limiter.available("c.com"));
+}
+
+TEST_CASE("per-host connection limit", M) {
+  ConnectionLimiter limiter;
+  limiter.setHostLimit("slow.com", 2);
+  REQUIRE(limiter.window("slow.com") == 2);
+
+  fill(limiter, "slow.com");
+  REQUIRE(limiter.active() == 2);
+
+  for(int i = 0; i < 10; ++i) {
+    limiter.succeeded("slow.com", 1000);
+    limiter.acquire("slow.com");
+  }
+  REQUIRE(limiter.window("slow.com") == 2);
+}
+
+TEST_CASE("additive connection increase", M) {
+  ConnectionLimiter limiter;
+
+  for(int i = 0; i < 5; ++i) {
+    limiter.acquire("a.com");
+    limiter.succeeded("a.com", 1000);
+  }
+  REQUIRE(limiter.window("a.com") == 6);
+
+  limiter.acquire("a.com");
+  limiter.succeeded("a.com", 1000);
+  REQUIRE(limiter.window("a.com") == 7);
+}
+
+TEST_CASE("slow transfers don't increase the window", M) {
+  ConnectionLimiter limiter;
+
+  limiter.acquire("a.com");
+  limiter.succeeded("a.com", 1000);
+
+  for(int i = 0; i < 10; ++i) {
+    limiter.acquire("a.com");
+    limiter.succeeded("a.com", 100);
+  }
+  REQUIRE(limiter.window("a.com") == 6);
+}
+
+TEST_CASE("multiplicative connection decrease", M) {
+  ConnectionLimiter limiter;
+  fill(limiter, "a.com");
+
+  limiter.congested("a.com");
+  REQUIRE(limiter.window("a.com") == 3);
+  REQUIRE(limiter.active() == 5);
+  REQUIRE_FALSE(limiter.available("a.com"));
+
+  limiter.congested("a.com");
+  limiter.congested("a.com");
+  limiter.congested("a.com");
+  REQUIRE(limiter.window("a.com") == 1);
+  REQUIRE(limiter.active() == 2);
+}
+
+TEST_CASE("configure connection limits", M) {
+  NetworkOpts opts{};
+  opts.maxConnections = 4;
+  opts.hostConnections = {{"a.com", 2}, {"b.com", 16}};
+
+  ConnectionLimiter limiter;
+  limiter.configure(opts);
+
+  REQUIRE(limiter.window("a.com") == 2);
+  REQUIRE(limiter.window("b.com") == 4);
+  REQUIRE(limiter.window("c.com") == 4);
+}
@@ -130,6 +130,28 @@ TEST_CASE("get latest stable version", M) {
   REQUIRE(pack.lastVersion(true) == alpha);
 }
 
+TEST_CASE("latest stable version added before older ones", M) {
+  Index ri("Remote Name");
+  Category cat("Category Name", &ri);
+  Package pack(Package::ScriptType, "a", &cat);
+
+  for(const char *name : {"1.1", "2.0-beta", "1.0", "0.9-alpha"}) {
+    Version *ver = new Version(name, &pack);
+    ver->addSource(new Source({}, "google.com", ver));
+    REQUIRE(pack.addVersion(ver));
+  }
+
+  REQUIRE(pack.version(0)->name().toString() == "0.9-alpha");
+  REQUIRE(pack.version(3)->name().toString() == "2.0-beta");
+  REQUIRE(pack.lastVersion(false)->name().toString() == "1.1");
+  REQUIRE(pack.lastVersion(true)->name().toString() == "2.0-beta");
+  REQUIRE(pack.lastVersion(false, {"1.1"})->name().toString() == "1.1");
+  REQUIRE(pack.lastVersion(false, {"2.0-alpha"})->name().toString() == "2.0-beta");
+  REQUIRE(pack.lastVersion(false, {"3.0"}) == nullptr);
+  REQUIRE(pack.findVersion({"1.0"}) == pack.version(1));
+  REQUIRE(pack.findVersion({"1.2"}) == nullptr);
+}
+
 TEST_CASE("pre-release updates", M) {
   Index ri("Remote Name");
   Category cat("Category Name", &ri);
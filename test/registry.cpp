@@ -1,8 +1,11 @@
 #include "helper.hpp"
 
 #include <registry.hpp>
+#include <registry_cache.hpp>
 
+#include <database.hpp>
 #include <errors.hpp>
+#include <filesystem.hpp>
 #include <index.hpp>
 #include <package.hpp>
 #include <remote.hpp>
@@ -81,6 +84,21 @@ TEST_CASE("bump version", M) {
   REQUIRE(entry2.id == entry1.id);
 }
 
+TEST_CASE("query outdated entry", M) {
+  MAKE_PACKAGE
+
+  Version older("1.0-beta", &pkg), newer("1.0.1", &pkg);
+
+  Registry reg;
+  REQUIRE_FALSE(reg.getOutdated(&newer));
+
+  const Registry::Entry &entry = reg.push(&ver);
+  REQUIRE(reg.getOutdated(&newer) == entry);
+  REQUIRE(reg.getOutdated(&newer).version == ver.name());
+  REQUIRE_FALSE(reg.getOutdated(&ver));
+  REQUIRE_FALSE(reg.getOutdated(&older));
+}
+
 TEST_CASE("get file list", M) {
   MAKE_PACKAGE
 
@@ -127,6 +145,20 @@ TEST_CASE("forget registry entry", M) {
   REQUIRE(afterForget.id == 0); // uninstalled
 }
 
+TEST_CASE("registry entries rolled back", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  REQUIRE_FALSE(reg.getEntry(&pkg)); // loads the repository's entries
+
+  reg.savepoint();
+  REQUIRE(reg.push(&ver));
+  REQUIRE(reg.getEntry(&pkg));
+
+  reg.restore();
+  REQUIRE_FALSE(reg.getEntry(&pkg));
+}
+
 TEST_CASE("file conflicts", M) {
   Registry reg;
 
@@ -215,3 +247,146 @@ TEST_CASE("get file owner", M) {
   const Registry::Entry &entry = reg.push(&ver);
   REQUIRE(reg.getOwner(src->targetPath()) == entry);
 }
+
+TEST_CASE("migrate registry to sortable version keys", M) {
+  const Path path("test/registry_migration.db");
+  FS::remove(path);
+
+  {
+    Database db(path.join());
+    db.exec(
+      "CREATE TABLE entries ("
+      "  id INTEGER PRIMARY KEY,"
+      "  remote TEXT NOT NULL,"
+      "  category TEXT NOT NULL,"
+      "  package TEXT NOT NULL,"
+      "  desc TEXT NOT NULL,"
+      "  type INTEGER NOT NULL,"
+      "  version TEXT NOT NULL,"
+      "  author TEXT NOT NULL,"
+      "  flags INTEGER DEFAULT 0,"
+      "  UNIQUE(remote, category, package)"
+      ");"
+      "CREATE TABLE files ("
+      "  id INTEGER PRIMARY KEY,"
+      "  entry INTEGER NOT NULL,"
+      "  path TEXT UNIQUE NOT NULL,"
+      "  main INTEGER NOT NULL,"
+      "  type INTEGER NOT NULL"
+      ");"
+      "INSERT INTO entries VALUES(NULL, 'a', 'b', 'c', '', 1, '1.10', '', 0);"
+      "INSERT INTO entries VALUES(NULL, 'a', 'b', 'd', '', 1, '1.2', '', 0);"
+      "INSERT INTO entries VALUES(NULL, 'a', 'b', 'e', '', 1, '1.2-beta', '', 0);"
+    );
+    db.setVersion({0, 6});
+  }
+
+  {
+    Registry reg(path);
+    MAKE_PACKAGE
+    reg.push(&ver);
+    reg.commit();
+  }
+
+  std::vector<std::string> versions;
+
+  {
+    const Registry reg(path, Registry::ReadOnly);
+    const std::vector<Registry::Entry> &entries = reg.getAllEntries();
+    REQUIRE(entries.size() == 4);
+
+    for(const Registry::Entry &entry : entries)
+      REQUIRE(entry.version == VersionName(entry.version.toString()));
+  }
+
+  {
+    Database db(path.join());
+    Statement stmt("SELECT version FROM entries ORDER BY version_key", &db);
+    stmt.exec([&] {
+      versions.push_back(stmt.stringColumn(0));
+      return true;
+    });
+  }
+
+  FS::remove(path);
+
+  REQUIRE(versions == std::vector<std::string>{"1.0", "1.2-beta", "1.2", "1.10"});
+}
+
+TEST_CASE("read-only registry while a transaction is open", M) {
+  const Path path("test/registry_readonly.db");
+  FS::remove(path);
+
+  MAKE_PACKAGE
+
+  {
+    Registry writer(path);
+    writer.push(&ver);
+    writer.commit();
+
+    Version ver2("2.0", &pkg);
+    ver2.addSource(new Source("file", "url", &ver2));
+
+    writer.savepoint();
+    writer.push(&ver2); // uncommitted, the database remains locked
+
+    const Registry reader(path, Registry::ReadOnly);
+    const Registry::Entry &entry = reader.getEntry(&pkg);
+    REQUIRE(entry.version.toString() == "1.0");
+    REQUIRE(reader.getOwner(src->targetPath()) == entry);
+    REQUIRE(reader.getFiles(entry).size() == 1);
+  }
+
+  FS::remove(path);
+  FS::remove(Path("test/registry_readonly.db-wal"));
+  FS::remove(Path("test/registry_readonly.db-shm"));
+}
+
+TEST_CASE("in-memory copy of the registry", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  const Registry::Entry &entry = reg.push(&ver);
+
+  const RegistryCache cache(reg);
+  REQUIRE(cache.entries().size() == 1);
+  REQUIRE(cache.getOwner(src->targetPath()) == entry);
+  REQUIRE(cache.getOwner(src->targetPath()).version == entry.version);
+  REQUIRE_FALSE(cache.getOwner(Path("unknown")));
+
+  const auto &files = cache.getFiles(entry);
+  REQUIRE(files.size() == 1);
+  REQUIRE(files[0].path == src->targetPath());
+  REQUIRE(files[0].type == Package::ScriptType);
+  REQUIRE(cache.getFiles({}).empty());
+}
+
+TEST_CASE("consistent reads while another connection commits", M) {
+  const Path path("test/registry_consistent.db");
+  FS::remove(path);
+
+  MAKE_PACKAGE
+
+  {
+    Registry writer(path);
+    const Registry::Entry &entry = writer.push(&ver);
+    writer.commit();
+
+    const Registry reader(path, Registry::ReadOnly);
+    size_t entries = 0, files = 0;
+
+    reader.readConsistent([&] {
+      entries = reader.getAllEntries().size();
+      writer.forget(entry);
+      reader.getAllFiles([&] (Registry::Entry::id_t, Registry::File &&) { ++files; });
+    });
+
+    REQUIRE(entries == 1);
+    REQUIRE(files == 1);
+    REQUIRE(reader.getAllEntries().empty());
+  }
+
+  FS::remove(path);
+  FS::remove(Path("test/registry_consistent.db-wal"));
+  FS::remove(Path("test/registry_consistent.db-shm"));
+}
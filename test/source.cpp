@@ -212,3 +212,13 @@ TEST_CASE("source checksum", M) {
   src.setChecksum("hello world");
   REQUIRE(src.checksum() == "hello world");
 }
+
+TEST_CASE("source size", M) {
+  MAKE_VERSION;
+
+  Source src({}, "url", &ver);
+  REQUIRE(src.size() == 0);
+
+  src.setSize(1024);
+  REQUIRE(src.size() == 1024);
+}
@@ -0,0 +1,111 @@
+#include "helper.hpp"
+
+#include <filesystem.hpp>
+#include <hash.hpp>
+#include <store.hpp>
+
+static const char *M = "[store]";
+
+static const std::string CHECKSUM =
+  "12206037d8ee6ebd2ea3cef71bf2d2a0bde0b10cbd4e1b2d1d1f9e8b4d6a4c6b9e4f";
+
+TEST_CASE("store object path", M) {
+  Path expected = Path::STORE;
+  expected.append("60");
+  expected.append(CHECKSUM);
+
+  REQUIRE(Store::pathFor(CHECKSUM) == expected);
+}
+
+TEST_CASE("find missing object", M) {
+  Store store;
+  REQUIRE(store.find(CHECKSUM).empty());
+  REQUIRE(store.size() == 0);
+}
+
+TEST_CASE("reject invalid checksums", M) {
+  Store store;
+
+  SECTION("empty") {
+    REQUIRE(store.find({}).empty());
+    REQUIRE_FALSE(store.add(Path("file"), {}));
+  }
+
+  SECTION("unsupported algorithm") {
+    const std::string checksum = "ff" + CHECKSUM.substr(2);
+    REQUIRE(store.find(checksum).empty());
+    REQUIRE_FALSE(store.add(Path("file"), checksum));
+  }
+
+  SECTION("path traversal") {
+    const std::string checksum = CHECKSUM.substr(0, 6) + "/../.." +
+      CHECKSUM.substr(12);
+    REQUIRE(store.find(checksum).empty());
+    REQUIRE_FALSE(store.add(Path("file"), checksum));
+  }
+}
+
+TEST_CASE("trim empty store", M) {
+  Store store;
+  store.trim(0);
+  REQUIRE(store.size() == 0);
+}
+
+TEST_CASE("remember download sizes", M) {
+  Store store;
+  REQUIRE(store.sizeHint(Path("Scripts/a.lua")) == 0);
+
+  store.setSizeHint(Path("Scripts/a.lua"), 42);
+  store.setSizeHint(Path("Scripts/b.lua"), 1);
+  REQUIRE(store.sizeHint(Path("Scripts/a.lua")) == 42);
+
+  store.setSizeHint(Path("Scripts/a.lua"), 64);
+  REQUIRE(store.sizeHint(Path("Scripts/a.lua")) == 64);
+}
+
+TEST_CASE("detect corrupt store objects", M) {
+  UseRootPath root(Path("test/indexes"));
+
+  const std::string contents = "hello world";
+  Hash hash(Hash::SHA256);
+  hash.addData(contents.data(), contents.size());
+  const std::string checksum = hash.digest();
+
+  const Path &object = Store::pathFor(checksum);
+  const Path target("store_test/file.lua");
+
+  SECTION("intact") {
+    REQUIRE(FS::write(object, contents));
+
+    FileCopy copy(object, target, checksum);
+    copy.exec();
+    REQUIRE(copy.state() == ThreadTask::Success);
+    REQUIRE_FALSE(copy.corruptSource());
+  }
+
+  SECTION("truncated") {
+    REQUIRE(FS::write(object, contents.substr(0, 5)));
+
+    FileCopy copy(object, target, checksum);
+    copy.exec();
+    REQUIRE(copy.state() == ThreadTask::Failure);
+    REQUIRE(copy.corruptSource());
+  }
+
+  SECTION("missing") {
+    FileCopy copy(object, target, checksum);
+    copy.exec();
+    REQUIRE(copy.state() == ThreadTask::Failure);
+    REQUIRE(copy.corruptSource());
+  }
+
+  Store store;
+  store.remove(checksum);
+  REQUIRE_FALSE(FS::exists(object));
+  REQUIRE(store.find(checksum).empty());
+
+  FS::remove(TempPath(target).temp());
+  FS::remove(target.dirname());
+  FS::remove(object.dirname());
+  FS::remove(Path::STORE);
+}
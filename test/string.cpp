@@ -26,6 +26,14 @@ TEST_CASE("pretty-print numbers", M) {
   REQUIRE(String::number(42'000'000) == "42,000,000");
 }
 
+TEST_CASE("pretty-print byte sizes", M) {
+  REQUIRE(String::bytes(0) == "0 bytes");
+  REQUIRE(String::bytes(1023) == "1023 bytes");
+  REQUIRE(String::bytes(1536) == "1.5 KB");
+  REQUIRE(String::bytes(5 * 1024 * 1024) == "5.0 MB");
+  REQUIRE(String::bytes(int64_t(3) << 40) == "3072.0 GB");
+}
+
 TEST_CASE("strip RTF header", M) {
   REQUIRE("Hello World" == String::stripRtf(R"(
     {\rtf1\ansi{\fonttbl\f0\fswiss Helvetica;}\f0\pard
@@ -0,0 +1,125 @@
+#include "helper.hpp"
+
+#include <filesystem.hpp>
+#include <path.hpp>
+#include <telemetry.hpp>
+
+#include <catch2/catch_approx.hpp>
+#include <fstream>
+#include <sstream>
+
+using Catch::Matchers::ContainsSubstring;
+using Catch::Matchers::EndsWith;
+using Catch::Matchers::StartsWith;
+
+static const char *M = "[telemetry]";
+static const Path RIPATH("test/indexes");
+
+static TransferStats transfer(const std::string &host, const bool reused)
+{
+  TransferStats stats{host};
+  stats.nameLookup = reused ? 0 : 0.010;
+  stats.connect = reused ? 0 : 0.030;
+  stats.appConnect = reused ? 0 : 0.090;
+  stats.startTransfer = reused ? 0.050 : 0.190;
+  stats.total = reused ? 0.250 : 0.590;
+  stats.size = 1024;
+  stats.httpVersion = "2";
+  stats.reused = reused;
+  return stats;
+}
+
+TEST_CASE("aggregate transfer stats per host", M) {
+  NetworkStats stats;
+  REQUIRE(stats.empty());
+
+  stats.add(transfer("a.com", false));
+  stats.add(transfer("b.com", false));
+  stats.add(transfer("a.com", true));
+
+  REQUIRE(stats.hosts().size() == 2);
+
+  const HostStats &host = stats.hosts()[0];
+  REQUIRE(host.host() == "a.com");
+  REQUIRE(host.transfers() == 2);
+  REQUIRE(host.connections() == 1);
+  REQUIRE(host.bytes() == 2048);
+
+  // connection setup is only averaged over the new connections
+  REQUIRE(host.dns() == Catch::Approx(0.010));
+  REQUIRE(host.connect() == Catch::Approx(0.020));
+  REQUIRE(host.tls() == Catch::Approx(0.060));
+
+  REQUIRE(host.firstByte() == Catch::Approx(0.075));
+  REQUIRE(host.download() == Catch::Approx(0.300));
+  REQUIRE(host.total() == Catch::Approx(0.420));
+  REQUIRE(host.slowest() == Catch::Approx(0.590));
+  REQUIRE(host.speed() == Catch::Approx(2048 / 0.840));
+}
+
+TEST_CASE("failed transfer stats", M) {
+  TransferStats failed{"a.com"};
+  failed.nameLookup = 0.5;
+  failed.total = 0.5;
+
+  NetworkStats stats;
+  stats.add(failed);
+
+  const HostStats &host = stats.hosts()[0];
+  REQUIRE(host.dns() == Catch::Approx(0.5));
+  REQUIRE(host.connect() == 0);
+  REQUIRE(host.firstByte() == 0);
+  REQUIRE(host.total() == Catch::Approx(0.5));
+}
+
+TEST_CASE("transfer stats to JSON", M) {
+  NetworkStats stats;
+  stats.add(transfer("a\"b.com", false));
+
+  const std::string &json = stats.toJSON(1234);
+  REQUIRE_THAT(json, StartsWith(R"({"time":1234,"hosts":[{"host":"a\"b.com",)"));
+  REQUIRE_THAT(json, ContainsSubstring(R"("transfers":1,"connections":1,"bytes":1024,)"));
+  REQUIRE_THAT(json, ContainsSubstring(R"("tls":0.0600,)"));
+  REQUIRE_THAT(json, EndsWith(R"("http":{"2":1}}]})"));
+}
+
+TEST_CASE("format host stats", M) {
+  HostStats host("a.com");
+  host.add(transfer("a.com", false));
+
+  std::ostringstream stream;
+  stream << host;
+
+  REQUIRE(stream.str() ==
+    "a.com:\r\n"
+    "  1 transfer, 1.0 KB at 1.7 KB/s\r\n"
+    "  1 new connection: DNS 10 ms, connect 20 ms, TLS 60 ms\r\n"
+    "  Average: first byte 100 ms, download 400 ms, total 590 ms (slowest 590 ms)"
+  );
+}
+
+TEST_CASE("save transfer stats", M) {
+  UseRootPath root(RIPATH);
+  const Path path("ReaPack/network_test.jsonl");
+
+  NetworkStats stats;
+  stats.add(transfer("a.com", false));
+
+  for(time_t i = 0; i < 102; ++i)
+    REQUIRE(stats.save(path, i));
+
+  std::ifstream file;
+  REQUIRE(FS::open(file, path));
+
+  std::vector<std::string> lines;
+  for(std::string line; std::getline(file, line);)
+    lines.push_back(line);
+  file.close();
+
+  FS::remove(path);
+
+  // only the latest runs are kept
+  REQUIRE(lines.size() == 100);
+  REQUIRE_THAT(lines.front(), StartsWith(R"({"time":2,)"));
+  REQUIRE_THAT(lines.back(), StartsWith(R"({"time":101,)"));
+}
@@ -0,0 +1,121 @@
+#include "helper.hpp"
+
+#include <thread.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <reaper_plugin_functions.h>
+
+using namespace std::chrono;
+
+static const char *M = "[thread]";
+
+namespace {
+  class SleepTask : public ThreadTask {
+  public:
+    SleepTask(milliseconds duration, std::atomic_int *done)
+      : m_duration(duration), m_done(done) {}
+
+    bool concurrent() const override { return true; }
+
+  protected:
+    bool run() override
+    {
+      std::this_thread::sleep_for(m_duration);
+      ++*m_done;
+      return true;
+    }
+
+  private:
+    milliseconds m_duration;
+    std::atomic_int *m_done;
+  };
+
+  class BlockingTask : public ThreadTask {
+  public:
+    BlockingTask(std::shared_future<void> release) : m_release(release) {}
+
+    bool concurrent() const override { return true; }
+
+  protected:
+    bool run() override
+    {
+      m_release.wait();
+      return true;
+    }
+
+  private:
+    std::shared_future<void> m_release;
+  };
+
+  // pushes one long task followed by many short ones,
+  // and returns the time it took to run all of them
+  milliseconds makespan(const size_t workers, const milliseconds longTask,
+    const int shortTasks, const milliseconds shortTask)
+  {
+    plugin_register = [](const char *, void *) { return 0; };
+
+    std::atomic_int done = 0;
+    std::vector<std::unique_ptr<SleepTask>> tasks;
+    tasks.push_back(std::make_unique<SleepTask>(longTask, &done));
+    for(int i = 0; i < shortTasks; ++i)
+      tasks.push_back(std::make_unique<SleepTask>(shortTask, &done));
+
+    const auto start = steady_clock::now();
+
+    WorkerGroup group(workers);
+    for(const auto &task : tasks)
+      group.push(task.get());
+
+    while(done < static_cast<int>(tasks.size()))
+      std::this_thread::sleep_for(milliseconds(1));
+
+    return duration_cast<milliseconds>(steady_clock::now() - start);
+  }
+}
+
+TEST_CASE("idle workers steal queued tasks", M) {
+  plugin_register = [](const char *, void *) { return 0; };
+
+  std::promise<void> release;
+  BlockingTask blocking(release.get_future().share());
+
+  std::atomic_int done = 0;
+  std::vector<std::unique_ptr<SleepTask>> tasks;
+  for(int i = 0; i < 10; ++i)
+    tasks.push_back(std::make_unique<SleepTask>(milliseconds(0), &done));
+
+  {
+    // round-robin leaves half of the short tasks queued behind the
+    // blocked one, only the other worker can run them
+    WorkerGroup group(2);
+    group.push(&blocking);
+    for(const auto &task : tasks)
+      group.push(task.get());
+
+    for(int i = 0; i < 10000 && done < static_cast<int>(tasks.size()); ++i)
+      std::this_thread::sleep_for(milliseconds(1));
+
+    const int finished = done;
+    release.set_value();
+    REQUIRE(finished == static_cast<int>(tasks.size()));
+  }
+}
+
+TEST_CASE("work stealing makespan with skewed task sizes", "[thread][.benchmark]") {
+  for(const size_t workers : {2, 4, 6}) {
+    const milliseconds longTask(500), shortTask(25);
+    const int shortTasks = 60;
+
+    const auto time = makespan(workers, longTask, shortTasks, shortTask);
+
+    // lower bound is the long task; without stealing its worker would also
+    // run every N-th short task after it
+    const auto roundRobin = longTask + shortTask * (shortTasks / workers);
+
+    WARN(workers << " workers: " << time.count() << " ms (round-robin: "
+      << roundRobin.count() << " ms, lower bound: " << longTask.count() << " ms)");
+    REQUIRE(time < roundRobin);
+  }
+}
@@ -6,7 +6,11 @@
 #include <index.hpp>
 #include <package.hpp>
 
+#include <chrono>
+#include <random>
+#include <regex>
 #include <sstream>
+#include <variant>
 
 #define MAKE_PACKAGE \
   Index ri("Index Name"); \
@@ -326,3 +330,213 @@ TEST_CASE("output version", M) {
     REQUIRE(stream.str() == "v1.2.3\r\n  line1\r\n\r\n  line2");
   }
 }
+
+namespace {
+  // the original regex-based implementation, kept as the reference
+  // for the ordering semantics
+  struct ReferenceVersion {
+    typedef std::variant<uint16_t, std::string> Segment;
+
+    ReferenceVersion(const std::string &str)
+    {
+      static const std::regex pattern("\\d+|[a-zA-Z]+");
+
+      for(auto it = std::sregex_iterator(str.begin(), str.end(), pattern);
+          it != std::sregex_iterator(); ++it) {
+        const std::string &match = it->str(0);
+
+        if(isalpha(match[0])) {
+          if(segments.empty()) {
+            error = "invalid version name '" + str + "'";
+            return;
+          }
+
+          segments.push_back(match);
+          stable = false;
+        }
+        else {
+          const size_t first = match.find_first_not_of('0');
+          const std::string &digits = first == std::string::npos ? "0" : match.substr(first);
+
+          if(digits.size() > 5 || std::stoul(digits) > UINT16_MAX) {
+            error = "version segment overflow in '" + str + "'";
+            return;
+          }
+
+          segments.push_back(static_cast<uint16_t>(std::stoul(digits)));
+        }
+      }
+
+      if(segments.empty())
+        error = "invalid version name '" + str + "'";
+    }
+
+    int compare(const ReferenceVersion &o) const
+    {
+      for(size_t i = 0; i < std::max(segments.size(), o.segments.size()); ++i) {
+        const Segment &l = i < segments.size() ? segments[i] : Segment{},
+                      &r = i < o.segments.size() ? o.segments[i] : Segment{};
+
+        if(l.index() != r.index())
+          return l.index() < r.index() ? 1 : -1;
+        else if(l < r)
+          return -1;
+        else if(r < l)
+          return 1;
+      }
+
+      return 0;
+    }
+
+    std::vector<Segment> segments;
+    bool stable = true;
+    std::string error;
+  };
+
+  std::vector<std::string> versionCorpus(const size_t count)
+  {
+    std::vector<std::string> corpus {
+      "0", "1", "1.0", "1.0.0.0", "1.0.0.0.0.1", "1.1.1.1.1", "1.2.3.4.5.6.7",
+      "5.05", "5.5", "5.50", "00001", "65535", "65536", "1.65535.0.1",
+      "1.0a", "1.0b", "1.0-beta1", "1.0-beta", "1.0a.2", "1.0b.1", "1..2",
+      "2.0-alpha", "2.0-Alpha", "1.0rc1", "1.0_pre2", "v1.0", "hello", "", "...",
+    };
+
+    std::mt19937 random(42);
+    const char chars[] = "0123456789000111.....-abzAZ";
+
+    while(corpus.size() < count) {
+      std::string name;
+      const size_t size = 1 + random() % 12;
+
+      for(size_t i = 0; i < size; ++i)
+        name += chars[random() % (sizeof(chars) - 1)];
+
+      corpus.push_back(name);
+    }
+
+    return corpus;
+  }
+}
+
+TEST_CASE("version sort key", M) {
+  REQUIRE(VersionName().sortKey().empty());
+  REQUIRE(VersionName("1").sortKey() == VersionName("1.0.0").sortKey());
+  REQUIRE(VersionName("0").sortKey() > VersionName().sortKey());
+  REQUIRE(VersionName("1.0").sortKey() > VersionName("1.0-beta").sortKey());
+  REQUIRE(VersionName("1.0").sortKey() < VersionName("1.0.1").sortKey());
+  REQUIRE(VersionName("1.0a").sortKey() < VersionName("1.0b").sortKey());
+  REQUIRE(VersionName("1.2").sortKey() < VersionName("1.10").sortKey());
+  REQUIRE(VersionName("1.256").sortKey() > VersionName("1.255").sortKey());
+}
+
+TEST_CASE("restore version from segment data", M) {
+  const VersionName original("1.02-beta3");
+
+  VersionName ver;
+  REQUIRE(ver.restore(original.toString(), original.segmentData()));
+  REQUIRE(ver.toString() == "1.02-beta3");
+  REQUIRE(ver.size() == 4);
+  REQUIRE_FALSE(ver.isStable());
+  REQUIRE(ver == original);
+  REQUIRE(ver < VersionName("1.2"));
+  REQUIRE(ver > VersionName("1.2-alpha"));
+
+  SECTION("mismatched data") {
+    REQUIRE_FALSE(ver.restore("1", original.segmentData()));
+    REQUIRE_FALSE(ver.restore("1.0", {}));
+    REQUIRE_FALSE(ver.restore("1.0", "abc"));
+    REQUIRE(ver.toString() == "1.02-beta3");
+  }
+
+  SECTION("stale data") {
+    const std::string &data = VersionName("1.2.3").segmentData();
+    REQUIRE(ver.restore("1.2.3", data));
+    REQUIRE_FALSE(ver.restore("1.2.4", data));
+    REQUIRE_FALSE(ver.restore("1.2.30", data));
+    REQUIRE_FALSE(ver.restore("1.2.3.4", data));
+    REQUIRE_FALSE(ver.restore("1.2.a", data));
+    REQUIRE_FALSE(ver.restore("1.2.3a", data));
+    REQUIRE_FALSE(ver.restore("1.2.3", VersionName("1.2.3b").segmentData()));
+    REQUIRE(ver.toString() == "1.2.3");
+  }
+}
+
+TEST_CASE("version parsing and ordering match the reference", M) {
+  const std::vector<std::string> &corpus = versionCorpus(3000);
+  std::vector<std::pair<VersionName, ReferenceVersion>> valid;
+
+  for(const std::string &name : corpus) {
+    const ReferenceVersion reference(name);
+
+    VersionName ver;
+    std::string error;
+    const bool ok = ver.tryParse(name, &error);
+
+    INFO("version '" << name << "'");
+    REQUIRE(ok == reference.error.empty());
+    REQUIRE(error == reference.error);
+
+    if(ok) {
+      REQUIRE(ver.size() == reference.segments.size());
+      REQUIRE(ver.isStable() == reference.stable);
+      REQUIRE(ver.toString() == name);
+
+      VersionName restored;
+      REQUIRE(restored.restore(name, ver.segmentData()));
+      REQUIRE(restored.compare(ver) == 0);
+      REQUIRE(restored.isStable() == ver.isStable());
+      REQUIRE(restored.sortKey() == ver.sortKey());
+
+      valid.push_back({ver, reference});
+    }
+  }
+
+  for(size_t i = 0; i < valid.size(); ++i) {
+    for(size_t j = i; j < valid.size(); j += 1 + valid.size() / 50) {
+      const auto &[lver, lref] = valid[i];
+      const auto &[rver, rref] = valid[j];
+
+      INFO("comparing '" << lver.toString() << "' to '" << rver.toString() << "'");
+      REQUIRE(lver.compare(rver) == lref.compare(rref));
+      REQUIRE(rver.compare(lver) == rref.compare(lref));
+
+      const int keyOrder = lver.sortKey().compare(rver.sortKey());
+      REQUIRE((keyOrder > 0) - (keyOrder < 0) == lref.compare(rref));
+    }
+  }
+}
+
+TEST_CASE("version parsing and comparison time", "[version][.benchmark]") {
+  using namespace std::chrono;
+
+  std::vector<std::string> names;
+  for(const std::string &name : versionCorpus(100000)) {
+    if(VersionName().tryParse(name))
+      names.push_back(name);
+  }
+
+  auto start = steady_clock::now();
+  std::vector<VersionName> versions(names.begin(), names.end());
+  const auto parseTime = steady_clock::now() - start;
+
+  start = steady_clock::now();
+  std::sort(versions.begin(), versions.end());
+  const auto sortTime = steady_clock::now() - start;
+
+  std::vector<VersionName> numeric;
+  for(int i = 0; i < 100000; ++i) {
+    numeric.emplace_back(std::to_string(i % 7) + "." + std::to_string(i % 13)
+      + "." + std::to_string(i % 101));
+  }
+
+  start = steady_clock::now();
+  std::sort(numeric.begin(), numeric.end());
+  const auto numericTime = steady_clock::now() - start;
+
+  WARN(names.size() << " versions: parse "
+    << duration_cast<milliseconds>(parseTime).count() << " ms, sort "
+    << duration_cast<milliseconds>(sortTime).count() << " ms; sort "
+    << numeric.size() << " numeric versions "
+    << duration_cast<milliseconds>(numericTime).count() << " ms");
+}
@@ -2,6 +2,7 @@
 
 #include <xml.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 
@@ -160,3 +161,33 @@ TEST_CASE("get next sibling element", M) {
     REQUIRE(foo.nextSibling("baz").name() == "baz"s);
   }
 }
+
+TEST_CASE("parse document incrementally", M) {
+  const std::string data = R"(<root foo="bar"><child>hello world</child></root>)";
+
+  XmlParser parser;
+  for(size_t i = 0; i < data.size(); i += 3)
+    parser.write(data.data() + i, std::min<size_t>(3, data.size() - i));
+
+  const XmlDocument &doc = parser.finish();
+  REQUIRE(doc);
+  REQUIRE(doc.error() == nullptr);
+  REQUIRE(doc.root().name() == "root"s);
+  REQUIRE(*doc.root().attribute("foo") == "bar"s);
+  REQUIRE(*doc.root().firstChild("child").text() == "hello world"s);
+}
+
+TEST_CASE("parse truncated document incrementally", M) {
+  XmlParser invalid, valid;
+  invalid.write("<root><child>", 13);
+  valid.write("<root></root>", 13);
+
+  const XmlDocument &invalidDoc = invalid.finish();
+  REQUIRE(!invalidDoc);
+  REQUIRE(strlen(invalidDoc.error()) > 0);
+
+  // errors don't leak between documents parsed at the same time
+  const XmlDocument &validDoc = valid.finish();
+  REQUIRE(validDoc);
+  REQUIRE(validDoc.error() == nullptr);
+}